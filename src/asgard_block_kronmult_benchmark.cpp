@@ -0,0 +1,143 @@
+
+#include <chrono>
+#include <iomanip>
+#include <string>
+
+#include "./device/asgard_kronmult.hpp"
+#include "permutations.hpp"
+
+#ifdef ASGARD_USE_OPENMP
+#include <omp.h>
+#endif
+
+using precision = asgard::default_precision;
+
+// number of levels in the multi-index, i.e., level 0 is index 0 and level 1 is index 1
+int index_level(int i)
+{
+  int l = 0;
+  while (i > 0)
+  {
+    i /= 2;
+    l += 1;
+  }
+  return l;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 4)
+  {
+    std::cout
+#ifdef ASGARD_ENABLE_DOUBLE
+        << "\n build for double precision"
+#else
+        << "\n build for single precision"
+#endif
+        << " using the block-global CPU kronmult\n"
+        << "\n Usage:\n"
+        << "./asgard_block_kronmult_benchmark <dimensions> <n> <level> [num_tests]\n\n"
+        << " e.g., ./asgard_block_kronmult_benchmark 3 3 7\n"
+        << "       ./asgard_block_kronmult_benchmark 4 2 8 20\n"
+        << "\n the benchmark runs with 1, 2, 4 ... threads up to OMP_NUM_THREADS,"
+        << "\n the workspace is allocated for each thread count, so the memory"
+        << "\n pages follow the threads, e.g., to see the scaling across sockets use\n"
+        << "   OMP_PROC_BIND=spread OMP_PLACES=cores ./asgard_block_kronmult_benchmark 3 3 7\n\n";
+    return 1;
+  }
+
+  int const num_dimensions = std::stoi(argv[1]);
+  int const n              = std::stoi(argv[2]);
+  int const level          = std::stoi(argv[3]);
+  int const num_tests      = (argc > 4) ? std::stoi(argv[4]) : 10;
+
+  auto indexes = asgard::permutations::generate_lower_index_set(
+      num_dimensions,
+      [&](std::array<int, asgard::max_num_dimensions> const &index) -> bool {
+        int L = 0;
+        for (int i = 0; i < num_dimensions; i++)
+          L += index_level(index[i]);
+        return (L <= level);
+      });
+
+  asgard::connect_1d conn(level, asgard::connect_1d::hierarchy::volume);
+
+  asgard::vector2d<int> ilist(num_dimensions, indexes);
+  asgard::dimension_sort dsort(ilist);
+
+  int64_t const block_size  = asgard::fm::ipow(n, num_dimensions);
+  int64_t const num_entries = block_size * ilist.num_strips();
+
+  std::cout << "benchmarking:\n"
+            << "dimensions: " << num_dimensions << "  n: " << n
+            << "  level: " << level << "  cells: " << ilist.num_strips() << "\n";
+
+  std::vector<std::vector<precision>> vals(num_dimensions);
+  for (auto &v : vals)
+  {
+    v.resize(n * n * conn.num_connections());
+    for (size_t i = 0; i < v.size(); i++)
+      v[i] = precision{1} / static_cast<precision>(1 + i % 7);
+  }
+
+  std::vector<asgard::kronmult::permutes> perms = {asgard::kronmult::permutes(num_dimensions)};
+  std::vector<int> flux_dir = {-1};
+  std::vector<int> terms    = {0};
+
+  asgard::kronmult::kron_roofline const roofline =
+      asgard::kronmult::block_global_roofline<precision>(
+          num_dimensions, n, block_size, ilist, dsort, perms, flux_dir, conn, conn,
+          terms, sizeof(precision));
+
+  std::cout << "Gflops: " << 1.E-9 * roofline.flops
+            << "  GB: " << 1.E-9 * roofline.bytes
+            << "  flops / byte: " << roofline.intensity() << "\n";
+
+#ifdef ASGARD_USE_OPENMP
+  int const max_threads = omp_get_max_threads();
+#else
+  int const max_threads = 1;
+#endif
+
+  double base_time = 0;
+  std::cout << std::fixed << std::setprecision(4);
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2)
+  {
+#ifdef ASGARD_USE_OPENMP
+    omp_set_num_threads(num_threads);
+#endif
+    // new workspace and vectors, first-touched by the current team
+    asgard::kronmult::block_global_workspace<precision> workspace;
+    asgard::kronmult::first_touch_vector<precision> x, y;
+    asgard::kronmult::first_touch_resize(x, num_entries);
+    asgard::kronmult::first_touch_resize(y, num_entries);
+    std::fill(x.begin(), x.end(), precision{1});
+
+    asgard::kronmult::sweep_tiles tiles(ilist, perms, block_size * sizeof(precision));
+
+    // dry run to build the plans and place the workspace
+    asgard::kronmult::global_cpu(num_dimensions, n, block_size, ilist, dsort, perms,
+                                 flux_dir, conn, conn, vals, terms, tiles,
+                                 x.data(), y.data(), workspace);
+
+    auto time_start = std::chrono::system_clock::now();
+    for (int i = 0; i < num_tests; i++)
+      asgard::kronmult::global_cpu(num_dimensions, n, block_size, ilist, dsort, perms,
+                                   flux_dir, conn, conn, vals, terms, tiles,
+                                   x.data(), y.data(), workspace);
+    auto time_end = std::chrono::system_clock::now();
+    double const elapsed =
+        std::chrono::duration<double, std::milli>(time_end - time_start).count() / num_tests;
+
+    if (num_threads == 1)
+      base_time = elapsed;
+
+    std::cout << "threads: " << std::setw(4) << num_threads
+              << "  time: " << elapsed << "ms"
+              << "  Gflops / second: " << ((elapsed > 0) ? 1.E-6 * roofline.flops / elapsed : 0.0)
+              << "  GB / second: " << ((elapsed > 0) ? 1.E-6 * roofline.bytes / elapsed : 0.0)
+              << "  speedup: " << ((elapsed > 0) ? base_time / elapsed : 0.0) << "\n";
+  }
+
+  return 0;
+}
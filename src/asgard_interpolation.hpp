@@ -5,8 +5,6 @@
 
 namespace asgard
 {
-#ifdef KRON_MODE_GLOBAL_BLOCK
-
 /*!
  * \brief Handles the interpolation operations in multidimensional context
  *
@@ -168,6 +166,4 @@ private:
   mutable kronmult::block_global_workspace<precision> *workspace_;
 };
 
-#endif
-
 } // namespace asgard
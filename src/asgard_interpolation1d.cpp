@@ -4,8 +4,6 @@
 
 namespace asgard
 {
-#ifdef KRON_MODE_GLOBAL_BLOCK
-
 /*
  * The 0 level basis (Legendre polynomials or simple Lagrane ones)
  * has support over the whole domain and it just linear functions.
@@ -576,5 +574,4 @@ template class wavelet_interp1d<1, double>;
 template class wavelet_interp1d<1, float>;
 #endif
 
-#endif // KRON_MODE_GLOBAL_BLOCK
 } // namespace asgard
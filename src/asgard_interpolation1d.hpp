@@ -4,8 +4,6 @@
 
 namespace asgard
 {
-#ifdef KRON_MODE_GLOBAL_BLOCK
-
 /*!
  * \brief Describes the 1D operations associated with wavelet interpolation
  *
@@ -101,5 +99,4 @@ private:
   std::vector<precision> hier2proj_;
 };
 
-#endif // KRON_MODE_GLOBAL_BLOCK
 } // namespace asgard
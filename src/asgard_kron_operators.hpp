@@ -1,29 +1,34 @@
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <limits>
+#include <unordered_map>
+
 #include "asgard_interpolation.hpp"
 
 namespace asgard
 {
-#ifndef KRON_MODE_GLOBAL
 /*!
- * \brief Holds a list of matrices used for time-stepping.
+ * \brief Holds a list of matrices used for time-stepping, local kronmult.
  *
  * There are multiple types of matrices based on the time-stepping and the
  * different terms being used. Matrices are grouped in one object so they can go
  * as a set and reduce the number of matrix making.
+ * Used by kron_operators when the backend is kron_backend::local.
  */
 template<typename precision>
-struct kron_operators
+struct local_kron_operators
 {
   //! \brief Makes a list of uninitialized matrices
-  kron_operators()
+  local_kron_operators()
   {
 #ifdef ASGARD_USE_GPU_MEM_LIMIT
     load_stream = nullptr;
 #endif
   }
   //! \brief Frees the matrix list and any cache vectors
-  ~kron_operators()
+  ~local_kron_operators()
   {
 #ifdef ASGARD_USE_GPU_MEM_LIMIT
     if (load_stream != nullptr)
@@ -46,6 +51,19 @@ struct kron_operators
     ignore(time);
     matrices[static_cast<int>(entry)].template apply<rec>(alpha, x, beta, y);
   }
+
+  void apply_block(imex_flag entry, int num_rhs, precision alpha, precision const *const x[],
+                   precision beta, precision *const y[]) const
+  {
+    apply_block(entry, 0, num_rhs, alpha, x, beta, y);
+  }
+  //! \brief Apply the given matrix entry to num_rhs vectors, gemm for n = 1
+  void apply_block(imex_flag entry, precision time, int num_rhs, precision alpha,
+                   precision const *const x[], precision beta, precision *const y[]) const
+  {
+    ignore(time);
+    matrices[static_cast<int>(entry)].apply_block(num_rhs, alpha, x, beta, y);
+  }
   int64_t flops(imex_flag entry) const
   {
     return matrices[static_cast<int>(entry)].flops();
@@ -172,14 +190,17 @@ private:
   cudaStream_t load_stream;
 #endif
 };
-#endif
-
-#ifdef KRON_MODE_GLOBAL_BLOCK
 
+/*!
+ * \brief Holds the block-global matrix and the interpolation data.
+ *
+ * Used by kron_operators when the backend is kron_backend::block_global,
+ * this is the only backend that handles the interpolation terms.
+ */
 template<typename precision>
-struct kron_operators
+struct block_global_kron_operators
 {
-  kron_operators() : pde_(nullptr), conn_volumes_(1), conn_full_(1) {}
+  block_global_kron_operators() : pde_(nullptr), conn_volumes_(1), conn_full_(1) {}
 
   template<resource rec = resource::host>
   void apply(imex_flag entry, precision alpha, precision const x[], precision beta, precision y[]) const
@@ -200,29 +221,77 @@ struct kron_operators
 
     // if any work will be done, copy x into the padded workspace
     if (kglobal.is_active(entry) or interp)
-      std::copy_n(x, kglobal.num_active(), workspace.x.begin());
+      kglobal.load_active(x, workspace.x.data());
 
     kglobal.template apply<rec>(entry, alpha, y);
 
     if (interp)
+      apply_interp(time, alpha, y);
+  }
+
+  void apply_block(imex_flag entry, int num_rhs, precision alpha, precision const *const x[],
+                   precision beta, precision *const y[]) const
+  {
+    apply_block(entry, precision{0}, num_rhs, alpha, x, beta, y);
+  }
+
+  /*!
+   * \brief Apply the given matrix entry to num_rhs vectors at once
+   *
+   * Computes y[v] = alpha * A * x[v] + beta * y[v] for all v < num_rhs.
+   * The vectors are interleaved internally so that each 1d coefficient
+   * and connectivity entry is loaded once for all vectors,
+   * which is much faster than num_rhs calls to apply().
+   */
+  void apply_block(imex_flag entry, precision time, int num_rhs, precision alpha,
+                   precision const *const x[], precision beta, precision *const y[]) const
+  {
+    if (num_rhs == 1)
+    {
+      apply(entry, time, alpha, x[0], beta, y[0]);
+      return;
+    }
+
+    int64_t const num_active = kglobal.num_active();
+
+    for (int v = 0; v < num_rhs; v++)
+    {
+      if (beta == 0)
+        kronmult::set_buffer_to_zero<resource::host>(num_active, y[v]);
+      else
+        lib_dispatch::scal<resource::host>(num_active, beta, y[v], 1);
+    }
+
+    if (kglobal.is_active(entry))
     {
-      // using the fact that workspace.x contains the padded values of x
-      // and workspace.y is extra scratch space that can be used here
-      interp.get_nodal_values(kglobal, domain_scale, workspace.x, workspace.y);
-      if (pde_->interp_nox())
+      int64_t const num_entries = kglobal.num_padded() * num_rhs;
+      kronmult::first_touch_resize(workspace.xrhs, num_entries);
+
+      precision *xrhs = workspace.xrhs.data();
+
+      int64_t const block_size = kglobal.block_size();
+      int64_t const num_cells  = num_active / block_size;
+#pragma omp parallel for
+      for (int64_t c = 0; c < num_cells; c++)
       {
-        pde_->interp_nox()(time, workspace.y, finterp);
+        int64_t const goffset = kglobal.grid_cell(c) * block_size;
+        for (int64_t j = 0; j < block_size; j++)
+          for (int v = 0; v < num_rhs; v++)
+            xrhs[(c * block_size + j) * num_rhs + v] = x[v][goffset + j];
       }
-      else // must be interp_x
+      std::fill(xrhs + num_active * num_rhs, xrhs + num_entries, precision{0});
+
+      kglobal.apply_block(entry, num_rhs, alpha, y);
+    }
+
+    if (interp)
+    {
+      // the non-linear interpolation terms are applied one vector at a time
+      for (int v = 0; v < num_rhs; v++)
       {
-        check_make_inodes();
-        pde_->interp_x()(time, inodes, workspace.y, finterp);
+        kglobal.load_active(x[v], workspace.x.data());
+        apply_interp(time, alpha, y[v]);
       }
-      interp.compute_hierarchical_coeffs(kglobal, finterp);
-      interp.get_projection_coeffs(kglobal, finterp, workspace.y);
-      alpha /= domain_scale;
-      for (int64_t i = 0; i < kglobal.num_active(); i++)
-        y[i] += alpha * workspace.y[i];
     }
   }
 
@@ -230,6 +299,11 @@ struct kron_operators
   {
     return kglobal.flops(entry);
   }
+  //! \brief Returns the flops, estimated memory traffic and intensity of the entry
+  kronmult::kron_roofline const &roofline(imex_flag entry) const
+  {
+    return kglobal.roofline(entry);
+  }
 
   //! \brief Make the matrix for the given entry
   void make(imex_flag entry, PDE<precision> const &pde,
@@ -259,7 +333,7 @@ struct kron_operators
     }
     if (not kglobal)
     {
-      kglobal = make_block_global_kron_matrix(pde, grid, &conn_volumes_, &conn_full_, &workspace);
+      kglobal = make_block_global_kron_matrix(pde, grid, opts, &conn_volumes_, &conn_full_, &workspace);
       set_specific_mode(pde, grid, opts, entry, kglobal);
       if (interp)
       {
@@ -269,6 +343,9 @@ struct kron_operators
     }
     else if (not kglobal.specific_is_set(entry))
       set_specific_mode(pde, grid, opts, entry, kglobal);
+    else
+      return;
+    set_multilevel(entry, pde, opts);
   }
 
   /*!
@@ -282,7 +359,10 @@ struct kron_operators
     if (not kglobal)
       make(entry, pde, grid, opts);
     else
+    {
       set_specific_mode(pde, grid, opts, entry, kglobal);
+      set_multilevel(entry, pde, opts);
+    }
   }
 
   //! \brief Clear all matrices
@@ -290,6 +370,7 @@ struct kron_operators
   {
     if (kglobal)
       kglobal = block_global_kron_matrix<precision>();
+    multilevel_ = block_multilevel_preconditioner<precision>();
   }
 
   //! \brief Returns the preconditioner.
@@ -298,6 +379,26 @@ struct kron_operators
   {
     return kglobal.template get_diagonal_preconditioner<rec>();
   }
+  //! \brief Returns true if the block-Jacobi preconditioner has been set.
+  bool has_block_preconditioner() const
+  {
+    return kglobal and kglobal.has_block_preconditioner();
+  }
+  //! \brief Applies the block-Jacobi preconditioner, x = (I - dt * D)^{-1} x
+  void apply_block_preconditioner(precision dt, precision x[]) const
+  {
+    kglobal.apply_block_preconditioner(dt, x);
+  }
+  //! \brief Returns true if the multilevel preconditioner has been set.
+  bool has_multilevel_preconditioner() const
+  {
+    return kglobal and multilevel_ and multilevel_.is_set();
+  }
+  //! \brief Applies one V-cycle of the multilevel preconditioner, x = M^{-1} x
+  void apply_multilevel_preconditioner(precision dt, precision x[]) const
+  {
+    multilevel_.apply(kglobal, dt, x);
+  }
 
   /*!
    * \brief Returns the inteprolation nodes, uses the padded grid.
@@ -321,7 +422,7 @@ struct kron_operators
   {
     if (not interp or not kglobal)
       throw std::runtime_error("get_nodals() requires enabled interpolation and made operators");
-    std::copy_n(x, kglobal.num_active(), workspace.x.begin());
+    kglobal.load_active(x, workspace.x.data());
     interp.get_nodal_values(kglobal, domain_scale, workspace.x, finterp);
     return finterp;
   }
@@ -337,15 +438,44 @@ struct kron_operators
   {
     if (not interp or not kglobal)
       throw std::runtime_error("get_nodals() requires enabled interpolation and made operators");
+    int64_t const num_active = kglobal.num_active();
     proj.resize(workspace.x.size());
-    std::copy_n(nodal, kglobal.num_active(), workspace.x.begin());
+    std::copy_n(nodal, num_active, workspace.x.begin());
     interp.compute_hierarchical_coeffs(kglobal, workspace.x);
     interp.get_projection_coeffs(kglobal.get_cells(), kglobal.get_dsort(),
                                  precision{1} / domain_scale,
-                                 workspace.x.data(), proj.data());
+                                 workspace.x.data(), workspace.y.data());
+    // the nodal values follow the cells, the projection follows the grid
+    std::fill_n(proj.data(), num_active, precision{0});
+    kglobal.add_active(precision{1}, workspace.y.data(), proj.data());
+    std::copy(workspace.y.begin() + num_active, workspace.y.begin() + proj.size(),
+              proj.data() + num_active);
   }
 
 private:
+  /*!
+   * \brief Adds the contribution of the interpolation terms to y
+   *
+   * Assumes that workspace.x contains the padded values of x,
+   * workspace.y is used as extra scratch space.
+   */
+  void apply_interp(precision time, precision alpha, precision y[]) const
+  {
+    interp.get_nodal_values(kglobal, domain_scale, workspace.x, workspace.y);
+    if (pde_->interp_nox())
+    {
+      pde_->interp_nox()(time, workspace.y, finterp);
+    }
+    else // must be interp_x
+    {
+      check_make_inodes();
+      pde_->interp_x()(time, inodes, workspace.y, finterp);
+    }
+    interp.compute_hierarchical_coeffs(kglobal, finterp);
+    interp.get_projection_coeffs(kglobal, finterp, workspace.y);
+    kglobal.add_active(alpha / domain_scale, workspace.y.data(), y);
+  }
+
   void check_make_inodes() const
   {
     if (inodes.empty())
@@ -359,12 +489,30 @@ private:
     }
   }
 
+  //! \brief Makes the coarse levels on the first use and loads the coefficients
+  void set_multilevel(imex_flag entry, PDE<precision> const &pde, options const &opts)
+  {
+    if (opts.precond != precond_opts::multilevel or
+        not (entry == imex_flag::imex_implicit or opts.use_implicit_stepping))
+      return;
+    if (not multilevel_)
+    {
+      multilevel_ = block_multilevel_preconditioner<precision>(
+          pde, opts, kglobal, &conn_volumes_, &conn_full_);
+      std::cout << "  multilevel preconditioner with " << multilevel_.num_levels()
+                << " levels, coarsest size "
+                << multilevel_.level_size(multilevel_.num_levels() - 1) << '\n';
+    }
+    multilevel_.set_coefficients(pde, opts, entry, kglobal);
+  }
+
   PDE<precision> const *pde_;
   precision domain_scale;
   std::array<precision, max_num_dimensions> dmin, dslope;
   connect_1d conn_volumes_, conn_full_;
 
   block_global_kron_matrix<precision> kglobal;
+  block_multilevel_preconditioner<precision> multilevel_;
 
   interpolation<precision> interp;
   mutable vector2d<precision> inodes;
@@ -373,6 +521,493 @@ private:
   mutable std::vector<precision> finterp; // scratch used only for interpolation
 };
 
+/*!
+ * \brief Approximate invariant subspace recycled between gmres solves (GCRO-DR)
+ *
+ * Holds U and C with C = A U and orthonormal columns of C,
+ * where A is the preconditioned implicit operator (I - dt * M).
+ * The space is updated at the end of every gmres cycle and it is
+ * used to deflate the next solves.
+ * If the coefficients or dt change, C is recomputed from U,
+ * if the grid changes, the space is discarded.
+ */
+template<typename precision>
+struct krylov_recycle
+{
+  //! \brief Number of vectors currently held
+  int size() const { return U.ncols(); }
+  //! \brief Discard the vectors, keeps the max_size
+  void clear()
+  {
+    U     = fk::matrix<precision>();
+    C     = fk::matrix<precision>();
+    stale = false;
+  }
+
+  fk::matrix<precision> U;
+  fk::matrix<precision> C;
+  //! \brief Indicates that the operator changed and C must be recomputed
+  bool stale = false;
+  //! \brief The time step used to compute C
+  precision dt = 0;
+  //! \brief Maximum number of vectors, zero disables the recycling
+  int max_size = 0;
+};
+
+/*!
+ * \brief Recent solutions of an implicit solve, used to extrapolate the initial guess
+ *
+ * Holds up to max_size solutions together with the times they correspond to,
+ * the initial guess for the next solve is the Lagrange polynomial through
+ * the stored solutions evaluated at the new time.
+ * The solutions are stored together with the element ids of the grid,
+ * if the grid is adapted, the solutions are remapped to the new grid
+ * with zeros for the new elements.
+ */
+template<typename precision>
+struct solution_history
+{
+  //! \brief Number of stored solutions
+  int size() const { return static_cast<int>(solutions.size()); }
+  //! \brief Discard the stored solutions, keeps the max_size
+  void clear()
+  {
+    solutions.clear();
+    times.clear();
+    ids.clear();
+  }
+  /*!
+   * \brief Stores the solution at the given time
+   *
+   * If the last stored solution has the same time, e.g., the step was
+   * repeated during adaptivity, the last solution is replaced.
+   */
+  void push(elements::table const &table, precision time,
+            fk::vector<precision> const &x)
+  {
+    if (max_size == 0)
+      return;
+    remap(table);
+    if (not times.empty() and times.back() == time)
+    {
+      solutions.back() = x;
+      return;
+    }
+    if (size() == max_size)
+    {
+      solutions.erase(solutions.begin());
+      times.erase(times.begin());
+    }
+    solutions.push_back(x);
+    times.push_back(time);
+  }
+  /*!
+   * \brief Writes the extrapolated solution at the given time into x
+   *
+   * Returns false and leaves x unchanged if there are no stored solutions.
+   */
+  bool extrapolate(elements::table const &table, precision time,
+                   fk::vector<precision> &x)
+  {
+    if (solutions.empty())
+      return false;
+    remap(table);
+    expect(x.size() == solutions.front().size());
+    x.scale(0);
+    for (int i = 0; i < size(); i++)
+    {
+      precision l = 1;
+      for (int j = 0; j < size(); j++)
+        if (j != i)
+          l *= (time - times[j]) / (times[i] - times[j]);
+      lib_dispatch::axpy(x.size(), l, solutions[i].data(), 1, x.data(), 1);
+    }
+    return true;
+  }
+
+  //! \brief Maximum number of stored solutions, zero disables the extrapolation
+  int max_size = 0;
+
+private:
+  //! \brief If the grid has changed, moves the solutions to the new grid
+  void remap(elements::table const &table)
+  {
+    int64_t const num_cells = table.size();
+    bool same = (static_cast<int64_t>(ids.size()) == num_cells);
+    for (int64_t i = 0; same and i < num_cells; i++)
+      same = (ids[i] == table.get_element_id(i));
+    if (same)
+      return;
+
+    std::vector<int64_t> new_ids(num_cells);
+    for (int64_t i = 0; i < num_cells; i++)
+      new_ids[i] = table.get_element_id(i);
+
+    if (not solutions.empty() and not ids.empty())
+    {
+      int64_t const block_size = solutions.front().size() / static_cast<int64_t>(ids.size());
+      std::unordered_map<int64_t, int64_t> old_index;
+      for (size_t i = 0; i < ids.size(); i++)
+        old_index[ids[i]] = static_cast<int64_t>(i);
+
+      for (auto &s : solutions)
+      {
+        fk::vector<precision> y(num_cells * block_size);
+        for (int64_t i = 0; i < num_cells; i++)
+        {
+          auto it = old_index.find(new_ids[i]);
+          if (it != old_index.end())
+            std::copy_n(s.data() + it->second * block_size, block_size,
+                        y.data() + i * block_size);
+        }
+        s = std::move(y);
+      }
+    }
+    else
+    {
+      solutions.clear();
+      times.clear();
+    }
+    ids = std::move(new_ids);
+  }
+
+  std::vector<fk::vector<precision>> solutions;
+  std::vector<precision> times;
+  std::vector<int64_t> ids;
+};
+
+/*!
+ * \brief Holds the kronmult operators, using the backend selected in the options.
+ *
+ * The backend is set when the first matrix is made and it is kept when
+ * the matrices are cleared, e.g., after the grid is adapted.
+ * With kron_backend::automatic, all eligible backends are made and timed
+ * on the current grid and the fastest one is kept.
+ */
+template<typename precision>
+struct kron_operators
+{
+  template<resource rec = resource::host>
+  void apply(imex_flag entry, precision alpha, precision const x[], precision beta, precision y[]) const
+  {
+    apply<rec>(entry, precision{0}, alpha, x, beta, y);
+  }
+  //! \brief Apply the given matrix entry
+  template<resource rec = resource::host>
+  void apply(imex_flag entry, precision time, precision alpha, precision const x[], precision beta, precision y[]) const
+  {
+    switch (backend_)
+    {
+    case kron_backend::local:
+      local_.template apply<rec>(entry, time, alpha, x, beta, y);
+      break;
+    case kron_backend::global:
+      global_.template apply<rec>(entry, time, alpha, x, beta, y);
+      break;
+    default: // kron_backend::block_global
+      if constexpr (rec == resource::host)
+        block_.apply(entry, time, alpha, x, beta, y);
+      else
+        throw std::runtime_error("the block-global kronmult is not available on the GPU");
+      break;
+    }
+  }
+
+  void apply_block(imex_flag entry, int num_rhs, precision alpha, precision const *const x[],
+                   precision beta, precision *const y[]) const
+  {
+    apply_block(entry, precision{0}, num_rhs, alpha, x, beta, y);
+  }
+  //! \brief Apply the given matrix entry to num_rhs vectors
+  void apply_block(imex_flag entry, precision time, int num_rhs, precision alpha,
+                   precision const *const x[], precision beta, precision *const y[]) const
+  {
+    switch (backend_)
+    {
+    case kron_backend::local:
+      local_.apply_block(entry, time, num_rhs, alpha, x, beta, y);
+      break;
+    case kron_backend::global:
+      global_.apply_block(entry, time, num_rhs, alpha, x, beta, y);
+      break;
+    default:
+      block_.apply_block(entry, time, num_rhs, alpha, x, beta, y);
+      break;
+    }
+  }
+
+  int64_t flops(imex_flag entry) const
+  {
+    switch (backend_)
+    {
+    case kron_backend::local:
+      return local_.flops(entry);
+    case kron_backend::global:
+      return global_.flops(entry);
+    default:
+      return block_.flops(entry);
+    }
+  }
+  /*!
+   * \brief Returns the flops, estimated memory traffic and intensity of the entry
+   *
+   * The memory traffic is estimated only by the block-global backend,
+   * the other backends report zero bytes.
+   */
+  kronmult::kron_roofline roofline(imex_flag entry) const
+  {
+    if (backend_ == kron_backend::block_global)
+      return block_.roofline(entry);
+    kronmult::kron_roofline result;
+    result.flops = flops(entry);
+    return result;
+  }
+
+  //! \brief Returns the backend in use, automatic means that no matrix has been made yet.
+  kron_backend backend() const { return backend_; }
+
+  //! \brief Make the matrix for the given entry
+  void make(imex_flag entry, PDE<precision> const &pde,
+            adapt::distributed_grid<precision> const &grid, options const &opts)
+  {
+    if (backend_ == kron_backend::automatic)
+    {
+      backend_ = select_backend(entry, pde, grid, opts);
+      recycle_.max_size = opts.gmres_recycle;
+      for (auto &h : history_)
+        h.max_size = opts.extrapolate;
+      if (opts.precond != precond_opts::jacobi
+          and backend_ != kron_backend::block_global)
+        std::cout << "  the " << (opts.precond == precond_opts::block_jacobi
+                                  ? "block-jacobi" : "multilevel")
+                  << " preconditioner requires the block kronmult, using jacobi\n";
+    }
+
+    switch (backend_)
+    {
+    case kron_backend::local:
+      local_.make(entry, pde, grid, opts);
+      break;
+    case kron_backend::global:
+      global_.make(entry, pde, grid, opts);
+      break;
+    default:
+      block_.make(entry, pde, grid, opts);
+      break;
+    }
+  }
+  /*!
+   * \brief Either makes the matrix or if it exists, just updates only the
+   *        coefficients
+   */
+  void reset_coefficients(imex_flag entry, PDE<precision> const &pde,
+                          adapt::distributed_grid<precision> const &grid,
+                          options const &opts)
+  {
+    switch (backend_)
+    {
+    case kron_backend::local:
+      local_.reset_coefficients(entry, pde, grid, opts);
+      break;
+    case kron_backend::global:
+      global_.reset_coefficients(entry, pde, grid, opts);
+      break;
+    case kron_backend::block_global:
+      block_.reset_coefficients(entry, pde, grid, opts);
+      break;
+    default: // nothing has been made yet
+      make(entry, pde, grid, opts);
+      break;
+    }
+    if (entry != imex_flag::imex_explicit)
+      recycle_.stale = true;
+  }
+
+  //! \brief Clear all matrices, the backend is kept
+  void clear()
+  {
+    local_.clear();
+    global_.clear();
+    block_.clear();
+    recycle_.clear();
+  }
+
+  /*!
+   * \brief Returns the gmres recycled space, see krylov_recycle
+   *
+   * The space is updated by the solver, hence the non-const reference.
+   */
+  krylov_recycle<precision> &get_recycle() const { return recycle_; }
+  /*!
+   * \brief Returns the history of solutions for the implicit solve of the stage
+   *
+   * Stage 0 is the implicit step or the first imex stage, stage 1 is the second
+   * imex stage. The history is kept when the matrices are cleared,
+   * see solution_history.
+   */
+  solution_history<precision> &get_history(int stage)
+  {
+    expect(0 <= stage and stage < 2);
+    return history_[stage];
+  }
+
+  //! \brief Returns the preconditioner.
+  template<resource rec>
+  auto const &get_diagonal_preconditioner() const
+  {
+    if constexpr (rec == resource::host)
+    {
+      if (backend_ == kron_backend::block_global)
+        return block_.template get_diagonal_preconditioner<rec>();
+    }
+    if (backend_ == kron_backend::local)
+      return local_.template get_diagonal_preconditioner<rec>();
+    return global_.template get_diagonal_preconditioner<rec>();
+  }
+  /*!
+   * \brief Returns true if the block-Jacobi preconditioner is available
+   *
+   * The preconditioner is selected with --precond block-jacobi
+   * and works only with the block-global backend.
+   */
+  bool has_block_preconditioner() const
+  {
+    return (backend_ == kron_backend::block_global and block_.has_block_preconditioner());
+  }
+  //! \brief Applies the block-Jacobi preconditioner, x = (I - dt * D)^{-1} x
+  void apply_block_preconditioner(precision dt, precision x[]) const
+  {
+    block_.apply_block_preconditioner(dt, x);
+  }
+  /*!
+   * \brief Returns true if the multilevel preconditioner is available
+   *
+   * The preconditioner is selected with --precond multilevel
+   * and works only with the block-global backend.
+   */
+  bool has_multilevel_preconditioner() const
+  {
+    return (backend_ == kron_backend::block_global and block_.has_multilevel_preconditioner());
+  }
+  //! \brief Applies one V-cycle of the multilevel preconditioner, x = M^{-1} x
+  void apply_multilevel_preconditioner(precision dt, precision x[]) const
+  {
+    block_.apply_multilevel_preconditioner(dt, x);
+  }
+
+  //! \brief Returns the inteprolation nodes, see block_global_kron_operators.
+  vector2d<precision> const &get_inodes() const { return block_.get_inodes(); }
+  //! \brief Convert to nodal values at the inodes, see block_global_kron_operators.
+  std::vector<precision> get_nodals(precision const x[]) const
+  {
+    return block_.get_nodals(x);
+  }
+  //! \brief Convert to projection from noal values, see block_global_kron_operators.
+  template<typename container_type>
+  void get_project(precision const nodal[], container_type &proj) const
+  {
+    block_.get_project(nodal, proj);
+  }
+
+private:
+  /*!
+   * \brief Returns the backend to use for this run.
+   *
+   * In automatic mode, each eligible backend makes the matrix for the entry
+   * and applies it a few times, the fastest one is kept and the others are cleared.
+   */
+  kron_backend select_backend(imex_flag entry, PDE<precision> const &pde,
+                              adapt::distributed_grid<precision> const &grid,
+                              options const &opts)
+  {
+    if (pde.has_interp()) // only the block-global backend handles interpolation
+    {
+      if (opts.kbackend != kron_backend::automatic
+          and opts.kbackend != kron_backend::block_global)
+        std::cout << "  the pde uses interpolation, switching to the block kronmult\n";
+      return kron_backend::block_global;
+    }
+    if (opts.kbackend != kron_backend::automatic)
+      return opts.kbackend;
+    if (get_num_ranks() > 1)
+      return kron_backend::local;
+
+    std::vector<kron_backend> candidates = {kron_backend::local, kron_backend::global};
+#ifndef ASGARD_USE_CUDA
+    candidates.push_back(kron_backend::block_global);
 #endif
 
+    int64_t const size = element_segment_size(pde)
+                         * static_cast<int64_t>(grid.get_subgrid(get_rank()).ncols());
+
+#ifdef ASGARD_USE_CUDA
+    constexpr resource trial_rec = resource::device;
+    fk::vector<precision, mem_type::owner, trial_rec> x(size), y(size);
+#else
+    constexpr resource trial_rec = resource::host;
+    fk::vector<precision> x(size), y(size);
+#endif
+
+    int constexpr num_trials = 3;
+
+    kron_backend best = candidates.front();
+    double best_time  = std::numeric_limits<double>::max();
+    for (kron_backend b : candidates)
+    {
+      backend_ = b;
+      make(entry, pde, grid, opts);
+      // the first product may also allocate the workspace
+      apply<trial_rec>(entry, precision{1}, x.data(), precision{0}, y.data());
+
+      auto const time_start = std::chrono::steady_clock::now();
+      for (int i = 0; i < num_trials; i++)
+        apply<trial_rec>(entry, precision{1}, x.data(), precision{0}, y.data());
+      double const elapsed = std::chrono::duration<double, std::milli>(
+                                 std::chrono::steady_clock::now() - time_start)
+                                 .count();
+
+      std::cout << "  kronmult backend trial, " << backend_name(b) << ": "
+                << elapsed / num_trials << "ms\n";
+      if (elapsed < best_time)
+      {
+        best      = b;
+        best_time = elapsed;
+      }
+    }
+    std::cout << "  kronmult backend: " << backend_name(best) << "\n";
+
+    // keep only the matrices of the selected backend
+    if (best != kron_backend::local)
+      local_.clear();
+    if (best != kron_backend::global)
+      global_.clear();
+    if (best != kron_backend::block_global)
+      block_.clear();
+
+    return best;
+  }
+
+  static char const *backend_name(kron_backend b)
+  {
+    switch (b)
+    {
+    case kron_backend::local:
+      return "local";
+    case kron_backend::global:
+      return "global";
+    default:
+      return "block";
+    }
+  }
+
+  kron_backend backend_ = kron_backend::automatic;
+
+  local_kron_operators<precision> local_;
+  global_kron_operators<precision> global_;
+  block_global_kron_operators<precision> block_;
+
+  mutable krylov_recycle<precision> recycle_;
+  std::array<solution_history<precision>, 2> history_;
+};
+
 } // namespace asgard
@@ -6,6 +6,16 @@
 #include <cuda_runtime.h>
 #endif
 
+#ifdef ASGARD_USE_CPU_MEM_LIMIT
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#endif
+
 namespace asgard
 {
 //! \brief Extract the actual set of terms based on options and imex flags
@@ -100,8 +110,6 @@ void build_preconditioner(PDE<precision> const &pde,
   }
 }
 
-#ifndef KRON_MODE_GLOBAL
-
 void check_available_memory(int64_t baseline_memory, int64_t available_MB)
 {
   if (available_MB < 2)
@@ -120,6 +128,96 @@ void check_available_memory(int64_t baseline_memory, int64_t available_MB)
   }
 }
 
+#ifdef ASGARD_USE_CPU_MEM_LIMIT
+ooc_index_file::~ooc_index_file()
+{
+  if (data_ != nullptr)
+    munmap(data_, size_);
+  if (fd_ >= 0)
+    close(fd_);
+}
+
+void ooc_index_file::append(fk::vector<int> const &row_indx,
+                            fk::vector<int> const &col_indx,
+                            fk::vector<int> const &index_A)
+{
+  expect(data_ == nullptr);
+  if (fd_ < 0)
+  {
+    // the file is unlinked right away, the space is released on close()
+    std::string name =
+        (std::filesystem::temp_directory_path() / "asgard_kronXXXXXX").string();
+    fd_ = mkstemp(name.data());
+    if (fd_ < 0)
+      throw std::runtime_error(
+          "cannot create the kronmult scratch file: " + std::string(std::strerror(errno)));
+    unlink(name.c_str());
+  }
+
+  // align the chunks to a page, so each one can be prefetched and released
+  int64_t const page = sysconf(_SC_PAGESIZE);
+
+  chunk c;
+  c.offset   = page * ((size_ + page - 1) / page);
+  c.num_rows = row_indx.size() - 1;
+  c.num_cols = col_indx.size();
+  c.num_iA   = index_A.size();
+  c.bytes    = static_cast<int64_t>(sizeof(int)) *
+             (int64_t{row_indx.size()} + c.num_cols + c.num_iA);
+
+  int64_t offset = c.offset;
+  for (auto const *v : {&row_indx, &col_indx, &index_A})
+  {
+    char const *data = reinterpret_cast<char const *>(v->data());
+    int64_t remain   = static_cast<int64_t>(sizeof(int)) * v->size();
+    while (remain > 0)
+    {
+      ssize_t const written = pwrite(fd_, data, remain, offset);
+      if (written < 0)
+        throw std::runtime_error(
+            "cannot write to the kronmult scratch file: " + std::string(std::strerror(errno)));
+      if (written == 0) // e.g., the disk is full
+        throw std::runtime_error(
+            "short write to the kronmult scratch file, wrote " +
+            std::to_string(offset - c.offset) + " out of " +
+            std::to_string(c.bytes) + " bytes");
+      data += written;
+      offset += written;
+      remain -= written;
+    }
+  }
+
+  size_ = c.offset + c.bytes;
+  chunks_.push_back(c);
+}
+
+void ooc_index_file::map()
+{
+  expect(fd_ >= 0 and data_ == nullptr);
+  data_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+  if (data_ == MAP_FAILED)
+  {
+    data_ = nullptr;
+    throw std::runtime_error(
+        "cannot map the kronmult scratch file: " + std::string(std::strerror(errno)));
+  }
+  // the chunks are read in order, let the kernel know
+  madvise(data_, size_, MADV_SEQUENTIAL);
+}
+
+void ooc_index_file::prefetch(int64_t c) const
+{
+  madvise(static_cast<char *>(data_) + chunks_[c].offset, chunks_[c].bytes,
+          MADV_WILLNEED);
+}
+
+void ooc_index_file::release(int64_t c) const
+{
+  madvise(static_cast<char *>(data_) + chunks_[c].offset, chunks_[c].bytes,
+          MADV_DONTNEED);
+}
+#endif
+
 template<typename precision>
 local_kronmult_matrix<precision>
 make_kronmult_dense(PDE<precision> const &pde,
@@ -390,6 +488,51 @@ void compute_coefficient_offsets(kron_sparse_cache const &spcache,
   compute_coefficient_offsets(spcache.cells1d, row_coords, col_coords, offsets);
 }
 
+#ifndef ASGARD_USE_CUDA
+/*!
+ * \brief Finds the first 1D non-zero of the operator rows for the multi-index
+ *
+ * Used with the packed index list, the offsets of the coefficients
+ * are stored relative to the beginning of the 1D rows.
+ */
+void compute_coefficient_row_begin(connect_1d const &cells1d,
+                                   int const *const row_coords,
+                                   std::vector<int> &row_begin)
+{
+  size_t num_dimensions = row_begin.size();
+  for (size_t j = 0; j < num_dimensions; j++)
+  {
+    int const oprow =
+        (row_coords[j] == 0)
+            ? 0
+            : ((1 << (row_coords[j] - 1)) + row_coords[j + num_dimensions]);
+
+    row_begin[j] = cells1d.row_begin(oprow);
+  }
+}
+
+//! \brief Size of the packed index list, see kronmult::cpu_sparse_packed()
+int64_t packed_index_size(int64_t num_rows, int64_t num_pairs,
+                          int num_dimensions)
+{
+  return num_rows * num_dimensions + (num_pairs * num_dimensions + 1) / 2;
+}
+
+//! \brief Packs the 16-bit offsets two per int, even ones in the lower bits
+void pack_index_offsets(std::vector<uint16_t> const &local, int packed[])
+{
+  int64_t const num_local  = static_cast<int64_t>(local.size());
+  int64_t const num_packed = (num_local + 1) / 2;
+#pragma omp parallel for
+  for (int64_t i = 0; i < num_packed; i++)
+  {
+    uint32_t const low  = local[2 * i];
+    uint32_t const high = (2 * i + 1 < num_local) ? local[2 * i + 1] : 0;
+    packed[i]           = static_cast<int>(low | (high << 16));
+  }
+}
+#endif
+
 template<typename precision>
 local_kronmult_matrix<precision>
 make_kronmult_sparse(PDE<precision> const &pde,
@@ -457,6 +600,12 @@ make_kronmult_sparse(PDE<precision> const &pde,
   int const tensor_size = fm::ipow<int>(kron_size, num_dimensions);
 #else
   std::vector<int> row_group_pntr; // group rows in the CPU case
+  // the packed list keeps the offsets in the 1D rows, see cpu_sparse_packed()
+  bool const packed = spcache.packed_index;
+  std::vector<uint16_t> local_offsets;
+#endif
+#ifdef ASGARD_USE_CPU_MEM_LIMIT
+  ooc_index_file ooc; // used only in out-of-core mode
 #endif
 
   std::vector<fk::vector<int>> list_iA;
@@ -465,13 +614,23 @@ make_kronmult_sparse(PDE<precision> const &pde,
 
   if (mem_stats.kron_call == memory_usage::one_call)
   {
+#ifdef ASGARD_USE_CUDA
     list_iA.push_back(
         fk::vector<int>(spcache.num_nonz * num_dimensions * num_terms));
-
-#ifdef ASGARD_USE_CUDA
     list_row_indx.push_back(fk::vector<int>(spcache.num_nonz));
     list_col_indx.push_back(fk::vector<int>(spcache.num_nonz));
 #else
+    if (packed)
+    {
+      list_iA.push_back(fk::vector<int>(
+          packed_index_size(num_rows, spcache.num_nonz, num_dimensions)));
+      local_offsets.resize(spcache.num_nonz * num_dimensions);
+    }
+    else
+    {
+      list_iA.push_back(
+          fk::vector<int>(spcache.num_nonz * num_dimensions * num_terms));
+    }
     list_row_indx.push_back(fk::vector<int>(num_rows + 1));
     list_col_indx.push_back(fk::vector<int>(spcache.num_nonz));
     std::copy_n(spcache.cconnect.begin(), num_rows, list_row_indx[0].begin());
@@ -482,6 +641,9 @@ make_kronmult_sparse(PDE<precision> const &pde,
 #pragma omp parallel
     {
       std::vector<int> offsets(num_dimensions); // find the 1D offsets
+#ifndef ASGARD_USE_CUDA
+      std::vector<int> row_begin(num_dimensions);
+#endif
 
 #pragma omp for
       for (int64_t row = grid.row_start; row < grid.row_stop + 1; row++)
@@ -493,10 +655,23 @@ make_kronmult_sparse(PDE<precision> const &pde,
 #endif
         auto ix = list_col_indx[0].begin() + c;
 
-        auto ia = list_iA[0].begin() + num_dimensions * num_terms * c;
-
         int const *const row_coords =
             flattened_table + 2 * num_dimensions * row;
+
+#ifdef ASGARD_USE_CUDA
+        auto ia = list_iA[0].begin() + num_dimensions * num_terms * c;
+#else
+        auto ia = list_iA[0].begin() +
+                  ((packed) ? (row - grid.row_start) * num_dimensions
+                            : num_dimensions * num_terms * c);
+        auto il = local_offsets.begin() + ((packed) ? num_dimensions * c : 0);
+        if (packed)
+        {
+          compute_coefficient_row_begin(spcache.cells1d, row_coords, row_begin);
+          for (int d = 0; d < num_dimensions; d++)
+            *ia++ = row_begin[d] * block1D_size + d * kron_squared;
+        }
+#endif
         // (L, p) = (row_coords[i], row_coords[i + num_dimensions])
         for (int64_t col = grid.col_start; col < grid.col_stop + 1; col++)
         {
@@ -515,6 +690,14 @@ make_kronmult_sparse(PDE<precision> const &pde,
             compute_coefficient_offsets(spcache, row_coords, col_coords,
                                         offsets);
 
+#ifndef ASGARD_USE_CUDA
+            if (packed)
+            {
+              for (int d = 0; d < num_dimensions; d++)
+                *il++ = static_cast<uint16_t>(offsets[d] - row_begin[d]);
+              continue;
+            }
+#endif
             for (int t = 0; t < num_terms; t++)
               for (int d = 0; d < num_dimensions; d++)
                 *ia++ = offsets[d] * block1D_size +
@@ -523,6 +706,11 @@ make_kronmult_sparse(PDE<precision> const &pde,
         }
       }
     }
+#ifndef ASGARD_USE_CUDA
+    if (packed)
+      pack_index_offsets(local_offsets,
+                         list_iA[0].data() + int64_t{num_rows} * num_dimensions);
+#endif
   }
   else
   { // split the problem into multiple chunks
@@ -594,6 +782,7 @@ make_kronmult_sparse(PDE<precision> const &pde,
 #else
     // CPU case, combine rows together into large groups but don't exceed the
     // work-size
+    std::vector<int64_t> chunk_units; // number of kron products in each chunk
     row_group_pntr.push_back(0);
     int64_t num_units = 0;
     for (int i = 0; i < num_rows; i++)
@@ -604,10 +793,7 @@ make_kronmult_sparse(PDE<precision> const &pde,
       if (num_units + nz_per_row > max_units)
       {
         // begin new chunk
-        list_iA.push_back(fk::vector<int>(num_units * kron_unit_size));
-        list_row_indx.push_back(fk::vector<int>(i - row_group_pntr.back() + 1));
-        list_col_indx.push_back(fk::vector<int>(num_units));
-
+        chunk_units.push_back(num_units);
         row_group_pntr.push_back(i);
         num_units = nz_per_row;
       }
@@ -617,24 +803,36 @@ make_kronmult_sparse(PDE<precision> const &pde,
       }
     }
     if (num_units > 0)
-    {
-      list_iA.push_back(fk::vector<int>(num_units * kron_unit_size));
-      list_row_indx.push_back(
-          fk::vector<int>(num_rows - row_group_pntr.back() + 1));
-      list_col_indx.push_back(fk::vector<int>(num_units));
-    }
+      chunk_units.push_back(num_units);
     row_group_pntr.push_back(num_rows);
 
+#ifdef ASGARD_USE_CPU_MEM_LIMIT
+    // if limited by the memory, the chunks go into a scratch file
+    // and only one chunk is held in RAM while building the lists
+    bool const out_of_core = (mem_stats.mem_limit == memory_usage::environment);
+#endif
+
     std::vector<int> offsets(num_dimensions);
+    std::vector<int> row_begin(num_dimensions);
 
     auto iconn       = spcache.cconnect.begin();
     int64_t shift_iy = 0;
 
     for (size_t i = 0; i < row_group_pntr.size() - 1; i++)
     {
-      auto ia = list_iA[i].begin();
-      auto ix = list_col_indx[i].begin();
-      auto iy = list_row_indx[i].begin();
+      int64_t const chunk_rows = row_group_pntr[i + 1] - row_group_pntr[i];
+      fk::vector<int> chunk_iA(
+          (packed) ? packed_index_size(chunk_rows, chunk_units[i], num_dimensions)
+                   : chunk_units[i] * kron_unit_size);
+      fk::vector<int> chunk_col_indx(chunk_units[i]);
+      fk::vector<int> chunk_row_indx(chunk_rows + 1);
+      if (packed)
+        local_offsets.resize(chunk_units[i] * num_dimensions);
+
+      auto ia = chunk_iA.begin();
+      auto ix = chunk_col_indx.begin();
+      auto iy = chunk_row_indx.begin();
+      auto il = local_offsets.begin();
 
       for (int64_t row = row_group_pntr[i]; row < row_group_pntr[i + 1]; row++)
       {
@@ -642,6 +840,13 @@ make_kronmult_sparse(PDE<precision> const &pde,
 
         int const *const row_coords =
             flattened_table + 2 * num_dimensions * row;
+
+        if (packed)
+        {
+          compute_coefficient_row_begin(spcache.cells1d, row_coords, row_begin);
+          for (int d = 0; d < num_dimensions; d++)
+            *ia++ = row_begin[d] * block1D_size + d * kron_squared;
+        }
         // (L, p) = (row_coords[i], row_coords[i + num_dimensions])
         for (int64_t col = grid.col_start; col < grid.col_stop + 1; col++)
         {
@@ -655,6 +860,12 @@ make_kronmult_sparse(PDE<precision> const &pde,
             compute_coefficient_offsets(spcache, row_coords, col_coords,
                                         offsets);
 
+            if (packed)
+            {
+              for (int d = 0; d < num_dimensions; d++)
+                *il++ = static_cast<uint16_t>(offsets[d] - row_begin[d]);
+              continue;
+            }
             for (int t = 0; t < num_terms; t++)
               for (int d = 0; d < num_dimensions; d++)
                 *ia++ = offsets[d] * block1D_size +
@@ -663,6 +874,10 @@ make_kronmult_sparse(PDE<precision> const &pde,
         }
       }
 
+      if (packed)
+        pack_index_offsets(local_offsets,
+                           chunk_iA.data() + chunk_rows * num_dimensions);
+
       if (i + 2 < row_group_pntr.size())
       {
         *iy++    = *iconn - shift_iy;
@@ -672,6 +887,17 @@ make_kronmult_sparse(PDE<precision> const &pde,
       {
         *iy++ = spcache.num_nonz - shift_iy;
       }
+
+#ifdef ASGARD_USE_CPU_MEM_LIMIT
+      if (out_of_core)
+      {
+        ooc.append(chunk_row_indx, chunk_col_indx, chunk_iA);
+        continue;
+      }
+#endif
+      list_iA.push_back(std::move(chunk_iA));
+      list_col_indx.push_back(std::move(chunk_col_indx));
+      list_row_indx.push_back(std::move(chunk_row_indx));
     }
 
 #endif
@@ -745,10 +971,20 @@ make_kronmult_sparse(PDE<precision> const &pde,
   }
 #else
 
+#ifdef ASGARD_USE_CPU_MEM_LIMIT
+  if (not ooc.empty())
+  {
+    ooc.map();
+    return local_kronmult_matrix<precision>(
+        num_dimensions, kron_size, num_rows, num_cols, num_terms,
+        std::move(ooc), std::move(vA), std::move(prec), packed);
+  }
+#endif
+
   return local_kronmult_matrix<precision>(
       num_dimensions, kron_size, num_rows, num_cols, num_terms,
       std::move(list_row_indx), std::move(list_col_indx), std::move(list_iA),
-      std::move(vA), std::move(prec));
+      std::move(vA), std::move(prec), packed);
 
 #endif
 }
@@ -760,15 +996,26 @@ make_local_kronmult_matrix(
     memory_usage const &mem_stats, imex_flag const imex, kron_sparse_cache &spcache,
     bool force_sparse)
 {
-  if (cli_opts.kmode == kronmult_mode::dense and not force_sparse)
-  {
-    return make_kronmult_dense<P>(pde, grid, cli_opts, imex);
-  }
-  else
+  local_kronmult_matrix<P> mat =
+      (cli_opts.kmode == kronmult_mode::dense and not force_sparse)
+          ? make_kronmult_dense<P>(pde, grid, cli_opts, imex)
+          : make_kronmult_sparse<P>(pde, grid, cli_opts, mem_stats, imex,
+                                    spcache);
+
+#ifndef ASGARD_USE_CUDA
+  // for n = 1 the Kronecker products are scalars, combine them into a matrix
+  // and use gemv/gemm, the dense matrix must fit in the memory limit
+  if (pde.get_dimensions()[0].get_degree() == 1)
   {
-    return make_kronmult_sparse<P>(pde, grid, cli_opts, mem_stats, imex,
-                                   spcache);
+    if (not mat.is_dense() or
+        get_MB<P>(int64_t{mat.output_size()} * mat.input_size()) <=
+            cli_opts.memory_limit)
+      mat.combine_scalar_products();
+    if (mat.is_scalar_combined())
+      std::cout << "  -- using the combined matrix of scalar products\n";
   }
+#endif
+  return mat;
 }
 
 template<typename P>
@@ -890,7 +1137,7 @@ compute_mem_usage(PDE<P> const &pde,
 
   memory_usage stats;
 
-#ifdef ASGARD_USE_GPU_MEM_LIMIT
+#if defined(ASGARD_USE_GPU_MEM_LIMIT) || defined(ASGARD_USE_CPU_MEM_LIMIT)
   if (memory_limit_MB == 0)
     memory_limit_MB = program_options.memory_limit;
 #else
@@ -1003,9 +1250,19 @@ compute_mem_usage(PDE<P> const &pde,
     base_line_entries += spcache.cells1d.num_connections() * num_dimensions *
                          pde.num_terms() * kron_size * kron_size;
 
+#ifndef ASGARD_USE_CUDA
+    // the packed list stores the offsets within the 1D rows in 16 bits
+    // n = 1 uses the combined products, see combine_scalar_products()
+    spcache.packed_index = (kron_size > 1);
+    for (int r = 0; r < spcache.cells1d.num_rows(); r++)
+      if (spcache.cells1d.row_end(r) - spcache.cells1d.row_begin(r) > 65536)
+        spcache.packed_index = false;
+#endif
+
     stats.baseline_memory = 1 + static_cast<int>(get_MB<P>(base_line_entries));
 
-#ifdef ASGARD_USE_GPU_MEM_LIMIT
+    // in the CPU out-of-core mode, the memory limit applies to the RAM
+#if defined(ASGARD_USE_GPU_MEM_LIMIT) || defined(ASGARD_USE_CPU_MEM_LIMIT)
     int64_t available_MB = memory_limit_MB - stats.baseline_memory;
     check_available_memory(stats.baseline_memory, available_MB);
 
@@ -1016,6 +1273,13 @@ compute_mem_usage(PDE<P> const &pde,
 #endif
 
     int64_t size_of_indexes = spcache.num_nonz * (matrices_per_prod + 2);
+#ifndef ASGARD_USE_CUDA
+    // the chunks of the multi-call mode are still sized by the full list
+    if (spcache.packed_index)
+      size_of_indexes = spcache.num_nonz * 2 +
+                        packed_index_size(num_rows, spcache.num_nonz,
+                                          num_dimensions);
+#endif
 
     if (size_of_indexes <= available_entries and size_of_indexes <= index_limit)
     {
@@ -1049,9 +1313,10 @@ compute_mem_usage(PDE<P> const &pde,
         stats.row_work_size = work_products / 2;
       }
 
-#ifdef ASGARD_USE_GPU_MEM_LIMIT
+#if defined(ASGARD_USE_GPU_MEM_LIMIT) || defined(ASGARD_USE_CPU_MEM_LIMIT)
       if (2 * stats.work_size + 2 * stats.row_work_size > available_entries)
       {
+        stats.mem_limit = memory_usage::environment;
         int64_t work_products =
             available_entries / (min_terms * num_dimensions + 2);
         stats.work_size     = min_terms * num_dimensions * (work_products / 2);
@@ -1066,9 +1331,6 @@ compute_mem_usage(PDE<P> const &pde,
   return stats;
 }
 
-#endif // KRON_MODE_GLOBAL
-
-#ifdef KRON_MODE_GLOBAL
 //! Returns true if the current term is identity and can be omitted
 template<typename precision>
 bool check_identity_term(PDE<precision> const &pde, int term_id, int dim)
@@ -1104,7 +1366,6 @@ int get_flux_direction(PDE<precision> const &pde, int term_id)
   return -1;
 }
 
-#ifndef KRON_MODE_GLOBAL_BLOCK
 /*!
  * \brief Walks over the sparse matrix pattern and makes call-back for each non-zero
  *
@@ -1596,10 +1857,6 @@ void global_kron_matrix<precision>::apply(
     y[i] += alpha * py[i];
 #endif
 }
-#endif // end ifndef KRON_MODE_GLOBAL_BLOCK
-#endif // end ifdef KRON_MODE_GLOBAL
-
-#ifdef KRON_MODE_GLOBAL_BLOCK
 
 template<typename precision>
 template<resource rec>
@@ -1612,21 +1869,162 @@ void block_global_kron_matrix<precision>::apply(
 
   std::fill_n(workspace_->y.begin(), num_padded_, precision{0});
 
-  kronmult::global_cpu(num_dimensions_, blockn_, block_size_, ilist_, dsort_,
-                       perms_, flux_dir_, *conn_volumes_, *conn_full_,
-                       gvals_, used_terms, workspace_->x.data(),
-                       workspace_->y.data(), *workspace_);
+  if (single_coeffs_)
+    kronmult::global_cpu(num_dimensions_, blockn_, block_size_, ilist_, dsort_,
+                         perms_, flux_dir_, *conn_volumes_, *conn_full_,
+                         gvals_single_, used_terms, tiles_, workspace_->x.data(),
+                         workspace_->y.data(), *workspace_);
+  else
+    kronmult::global_cpu(num_dimensions_, blockn_, block_size_, ilist_, dsort_,
+                         perms_, flux_dir_, *conn_volumes_, *conn_full_,
+                         gvals_, used_terms, tiles_, workspace_->x.data(),
+                         workspace_->y.data(), *workspace_);
+
+  add_active(alpha, workspace_->y.data(), y);
+}
+
+template<typename precision>
+void block_global_kron_matrix<precision>::apply_block(
+    imex_flag etype, int num_rhs, precision alpha, precision *const y[]) const
+{
+  int const imex = static_cast<int>(etype);
+
+  std::vector<int> const &used_terms = term_groups_[imex];
+
+  int64_t const num_entries = num_padded_ * num_rhs;
+  kronmult::first_touch_resize(workspace_->yrhs, num_entries);
+  std::fill_n(workspace_->yrhs.begin(), num_entries, precision{0});
+
+  if (single_coeffs_)
+    kronmult::global_cpu(num_dimensions_, blockn_, block_size_, ilist_, dsort_,
+                         perms_, flux_dir_, *conn_volumes_, *conn_full_,
+                         gvals_single_, used_terms, num_rhs, workspace_->xrhs.data(),
+                         workspace_->yrhs.data(), *workspace_);
+  else
+    kronmult::global_cpu(num_dimensions_, blockn_, block_size_, ilist_, dsort_,
+                         perms_, flux_dir_, *conn_volumes_, *conn_full_,
+                         gvals_, used_terms, num_rhs, workspace_->xrhs.data(),
+                         workspace_->yrhs.data(), *workspace_);
 
-  precision const *py = workspace_->y.data();
+  precision const *py = workspace_->yrhs.data();
+  int64_t const num_cells = num_active_ / block_size_;
 #pragma omp parallel for
-  for (int64_t i = 0; i < num_active_; i++)
-    y[i] += alpha * py[i];
+  for (int64_t c = 0; c < num_cells; c++)
+  {
+    int64_t const goffset = grid_cell(c) * block_size_;
+    for (int64_t j = 0; j < block_size_; j++)
+    {
+      precision const *const pyj = py + (c * block_size_ + j) * num_rhs;
+      for (int v = 0; v < num_rhs; v++)
+        y[v][goffset + j] += alpha * pyj[v];
+    }
+  }
+}
+
+template<typename precision>
+void block_global_kron_matrix<precision>::apply_block_preconditioner(
+    precision dt, precision x[]) const
+{
+  expect(block_pc_group_ >= 0);
+
+  int const bsize         = static_cast<int>(block_size_);
+  int64_t const num_cells = num_active_ / block_size_;
+  int64_t const bsize2    = block_size_ * block_size_;
+
+  if (block_pc_.empty() or dt != block_pc_dt_)
+  {
+    kronmult::first_touch_resize(block_pc_, num_cells * bsize2);
+    block_pc_pivots_.resize(num_cells * block_size_);
+
+    std::vector<int> const &terms = term_groups_[block_pc_group_];
+    int const n                   = blockn_;
+
+    // the block of cell c is sum_t kron_d D_{t,d}, where D_{t,d} is the diagonal
+    // n x n block of the 1D operator, i.e., the block in row/column ilist_[c][d]
+    // the last dimension is the fastest changing index within the cell
+    auto factor = [&](auto const &gvals) -> void {
+#pragma omp parallel
+      {
+        std::vector<decltype(gvals.front().data())> diag(num_dimensions_);
+#pragma omp for
+        for (int64_t c = 0; c < num_cells; c++)
+        {
+          precision *const B = block_pc_.data() + grid_cell(c) * bsize2;
+          std::fill_n(B, bsize2, precision{0});
+          for (int t : terms)
+          {
+            if (perms_[t].num_dimensions() == 0)
+              continue; // identity terms do not contribute to the kronmult
+            for (int d = 0; d < num_dimensions_; d++)
+            {
+              auto const &vals = gvals[t * num_dimensions_ + d];
+              if (vals.empty()) // identity direction
+              {
+                diag[d] = nullptr;
+                continue;
+              }
+              connect_1d const &conn = (flux_dir_[t] == d) ? *conn_full_ : *conn_volumes_;
+              diag[d] = vals.data() + int64_t{conn.row_diag(ilist_[c][d])} * n * n;
+            }
+            for (int col = 0; col < bsize; col++)
+              for (int row = 0; row < bsize; row++)
+              {
+                precision a = 1;
+                int ir = row, ic = col;
+                for (int d = num_dimensions_ - 1; d >= 0 and a != 0; d--)
+                {
+                  int const i = ir % n, k = ic % n;
+                  ir /= n;
+                  ic /= n;
+                  if (diag[d] == nullptr)
+                    a *= (i == k) ? precision{1} : precision{0};
+                  else
+                    a *= diag[d][k * n + i];
+                }
+                B[col * block_size_ + row] -= dt * a;
+              }
+          }
+          for (int i = 0; i < bsize; i++)
+            B[i * block_size_ + i] += 1;
+
+          int const info = lib_dispatch::getrf(
+              bsize, bsize, B, bsize, block_pc_pivots_.data() + grid_cell(c) * block_size_);
+          expect(info == 0);
+        }
+      }
+    };
+
+    if (single_coeffs_)
+      factor(gvals_single_);
+    else
+      factor(gvals_);
+
+    block_pc_dt_ = dt;
+  }
+
+#pragma omp parallel for
+  for (int64_t c = 0; c < num_cells; c++)
+    lib_dispatch::getrs('N', bsize, 1, block_pc_.data() + c * bsize2, bsize,
+                        block_pc_pivots_.data() + c * block_size_,
+                        x + c * block_size_, bsize);
 }
 
 template<typename precision>
 block_global_kron_matrix<precision>
 make_block_global_kron_matrix(PDE<precision> const &pde,
                               adapt::distributed_grid<precision> const &dis_grid,
+                              options const &program_options,
+                              connect_1d const *volumes, connect_1d const *fluxes,
+                              kronmult::block_global_workspace<precision> *workspace)
+{
+  return make_block_global_kron_matrix(pde, get_cells(pde.num_dims(), dis_grid),
+                                       program_options, volumes, fluxes, workspace);
+}
+
+template<typename precision>
+block_global_kron_matrix<precision>
+make_block_global_kron_matrix(PDE<precision> const &pde, vector2d<int> cells,
+                              options const &program_options,
                               connect_1d const *volumes, connect_1d const *fluxes,
                               kronmult::block_global_workspace<precision> *workspace)
 {
@@ -1638,7 +2036,6 @@ make_block_global_kron_matrix(PDE<precision> const &pde,
 
   int64_t block_size = fm::ipow(pterms, num_dimensions);
 
-  vector2d<int> cells = get_cells(num_dimensions, dis_grid);
   int const num_cells = cells.num_strips();
 
   indexset padded = compute_ancestry_completion(make_index_set(cells), *volumes);
@@ -1647,6 +2044,44 @@ make_block_global_kron_matrix(PDE<precision> const &pde,
   if (padded.num_indexes() > 0)
     cells.append(padded[0], padded.num_indexes());
 
+  // the grid order is lexicographic, which puts the cells coupled in
+  // the slow directions far apart, the Morton order keeps close cells together
+  std::vector<int> cell_order;
+  if (program_options.use_morton_order)
+  {
+    // true if the most significant bit of a is less than the one of b
+    auto less_msb = [](int a, int b) -> bool { return (a < b and a < (a ^ b)); };
+    auto morton_less = [&](int a, int b) -> bool {
+      int const *ia = cells[a];
+      int const *ib = cells[b];
+      int dim = 0, xmax = 0;
+      for (int d = 0; d < num_dimensions; d++)
+      {
+        int const x = ia[d] ^ ib[d];
+        if (less_msb(xmax, x))
+        {
+          xmax = x;
+          dim  = d;
+        }
+      }
+      return (ia[dim] < ib[dim]);
+    };
+
+    // the active cells must stay ahead of the padding
+    std::vector<int> order(cells.num_strips());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.begin() + num_cells, morton_less);
+    std::sort(order.begin() + num_cells, order.end(), morton_less);
+
+    vector2d<int> sorted(num_dimensions, cells.num_strips());
+    for (int64_t c = 0; c < cells.num_strips(); c++)
+      std::copy_n(cells[order[c]], num_dimensions, sorted[c]);
+    cells = std::move(sorted);
+
+    order.resize(num_cells);
+    cell_order = std::move(order);
+  }
+
   dimension_sort dsort(cells);
 
   // figure out the permutation patterns
@@ -1676,60 +2111,368 @@ make_block_global_kron_matrix(PDE<precision> const &pde,
   workspace->x.resize(num_padded);
   std::fill_n(workspace->x.begin(), num_padded, precision{0});
   workspace->y.resize(num_padded);
-  workspace->w1.resize(num_padded);
-  workspace->w2.resize(num_padded);
+  kronmult::first_touch_resize(workspace->w1, num_padded);
+  kronmult::first_touch_resize(workspace->w2, num_padded);
+  // the sweep plans are tied to the old cells
+  workspace->plans.clear();
 
   return block_global_kron_matrix<precision>(
       num_cells * block_size, num_padded,
       num_dimensions, pterms, block_size,
-      std::move(cells), std::move(dsort), std::move(permutations),
+      std::move(cells), std::move(cell_order), std::move(dsort), std::move(permutations),
       std::move(flux_dir), volumes, fluxes,
       workspace);
 }
 
 template<typename precision>
-void set_specific_mode(PDE<precision> const &pde,
-                       adapt::distributed_grid<precision> const &dis_grid,
-                       options const &program_options, imex_flag const imex,
-                       block_global_kron_matrix<precision> &mat)
+void set_specific_coefficients(PDE<precision> const &pde,
+                               options const &program_options, imex_flag const imex,
+                               block_global_kron_matrix<precision> &mat)
 {
   int const imex_indx = static_cast<int>(imex);
 
-  mat.term_groups_[imex_indx] = get_used_terms(pde, program_options, imex);
-
-  std::vector<int> const &used_terms = mat.term_groups_[imex_indx];
+  std::vector<int> const used_terms = get_used_terms(pde, program_options, imex);
 
   int const n = mat.blockn_;
 
   int const num_dimensions = pde.num_dims();
+  int const num_terms      = pde.num_terms();
 
-  for (int const t : used_terms)
+  // single precision coefficients halve the memory traffic of double runs,
+  // for float runs the two modes are the same
+  if constexpr (std::is_same_v<precision, double>)
+    mat.single_coeffs_ = program_options.use_single_kron;
+
+  // Terms with the same active directions and flux direction that differ in
+  // at most one direction are fused, since A_1 x B + A_2 x B = (A_1 + A_2) x B
+  // and the fused term needs the sweeps of only one term.
+  // The fused terms use the extra slots (1 + imex_indx) * num_terms + leader,
+  // so the different imex groups do not overwrite each other.
+  auto is_active = [&](int t, int d) -> bool { return not check_identity_term(pde, t, d); };
+  auto same_ops  = [&](int t1, int t2, int d) -> bool {
+    fk::matrix<precision> const &a = pde.get_coefficients(t1, d);
+    fk::matrix<precision> const &b = pde.get_coefficients(t2, d);
+    return (a.nrows() == b.nrows() and a.ncols() == b.ncols()
+            and std::equal(a.data(), a.data() + a.size(), b.data()));
+  };
+
+  std::vector<std::vector<int>> groups;
+  std::vector<int> group_dir; // the direction where the group differs
+  std::vector<bool> taken(used_terms.size(), false);
+  for (size_t i = 0; i < used_terms.size(); i++)
   {
-    for (int d = 0; d < num_dimensions; d++)
+    if (taken[i])
+      continue;
+    int const t = used_terms[i];
+    groups.push_back({t});
+    group_dir.push_back(-1);
+    if (mat.perms_[t].num_dimensions() == 0)
+      continue;
+
+    for (size_t j = i + 1; j < used_terms.size(); j++)
     {
-      if (not check_identity_term(pde, t, d))
+      int const u = used_terms[j];
+      if (taken[j] or mat.flux_dir_[u] != mat.flux_dir_[t])
+        continue;
+
+      int diff      = group_dir.back();
+      bool can_fuse = true;
+      for (int d = 0; d < num_dimensions and can_fuse; d++)
       {
-        fk::matrix<precision> const &ops = pde.get_coefficients(t, d);
+        if (is_active(t, d) != is_active(u, d))
+          can_fuse = false;
+        else if (is_active(t, d) and d != diff and not same_ops(t, u, d))
+        {
+          can_fuse = (diff == -1);
+          diff     = d;
+        }
+      }
+      if (can_fuse)
+      {
+        taken[j] = true;
+        groups.back().push_back(u);
+        group_dir.back() = diff;
+      }
+    }
+    if (groups.back().size() > 1 and group_dir.back() == -1)
+    { // all operators are the same, add them in any one direction
+      group_dir.back() = 0;
+      while (not is_active(t, group_dir.back()))
+        group_dir.back()++;
+    }
+  }
 
-        connect_1d const &conn = (mat.flux_dir_[t] == d) ? *mat.conn_full_ : *mat.conn_volumes_;
+  if (groups.size() < used_terms.size() and
+      static_cast<int>(mat.perms_.size()) == num_terms)
+  {
+    // first fusion, make the slots for the fused terms
+    for (int k = 0; k < num_imex_variants; k++)
+      for (int t = 0; t < num_terms; t++)
+      {
+        mat.perms_.push_back(mat.perms_[t]);
+        mat.flux_dir_.push_back(mat.flux_dir_[t]);
+      }
+    mat.gvals_.resize(mat.perms_.size() * num_dimensions);
+  }
+  if (mat.single_coeffs_)
+    mat.gvals_single_.resize(mat.gvals_.size());
+
+  std::vector<int> &fused_terms = mat.term_groups_[imex_indx];
+  fused_terms.clear();
+  for (size_t g = 0; g < groups.size(); g++)
+  {
+    int const t = groups[g].front();
+    int const v = (groups[g].size() == 1) ? t : (1 + imex_indx) * num_terms + t;
+    fused_terms.push_back(v);
+
+    for (int d = 0; d < num_dimensions; d++)
+    {
+      if (not is_active(t, d))
+        continue;
 
-        mat.gvals_[t * num_dimensions + d].resize(n * n * conn.num_connections());
+      fk::matrix<precision> ops = pde.get_coefficients(t, d);
+      if (d == group_dir[g])
+        for (size_t k = 1; k < groups[g].size(); k++)
+          ops = ops + pde.get_coefficients(groups[g][k], d);
 
-        precision *A = mat.gvals_[t * num_dimensions + d].data();
+      connect_1d const &conn = (mat.flux_dir_[t] == d) ? *mat.conn_full_ : *mat.conn_volumes_;
+
+      auto load_values = [&](auto &vals) {
+        vals.resize(n * n * conn.num_connections());
+        auto *A = vals.data();
         for (int r = 0; r < conn.num_rows(); r++)
           for (int j = conn.row_begin(r); j < conn.row_end(r); j++)
             for (int k = 0; k < n; k++)
               A = std::copy_n(ops.data(r * n, conn[j] * n + k), n, A);
-      }
+      };
+
+      if (mat.single_coeffs_)
+        load_values(mat.gvals_single_[v * num_dimensions + d]);
+      else
+        load_values(mat.gvals_[v * num_dimensions + d]);
     }
   }
+  // the work depends on the fused terms
+  mat.roofline_[imex_indx].flops = -1;
+}
+
+template<typename precision>
+void set_specific_mode(PDE<precision> const &pde,
+                       adapt::distributed_grid<precision> const &dis_grid,
+                       options const &program_options, imex_flag const imex,
+                       block_global_kron_matrix<precision> &mat)
+{
+  set_specific_coefficients(pde, program_options, imex, mat);
 
   if (imex == imex_flag::imex_implicit or program_options.use_implicit_stepping)
+  {
+    int const imex_indx = static_cast<int>(imex);
     // prepare a preconditioner
-    build_preconditioner(pde, dis_grid, used_terms, mat.pre_con_);
+    build_preconditioner(pde, dis_grid, get_used_terms(pde, program_options, imex),
+                         mat.pre_con_);
+
+    if (program_options.precond == precond_opts::block_jacobi)
+    {
+      // the factors are computed on the first use, when dt is known
+      mat.block_pc_.clear();
+      int64_t const num_entries = mat.num_active_ * mat.block_size_;
+      if (get_MB<precision>(num_entries) <= program_options.memory_limit)
+        mat.block_pc_group_ = imex_indx;
+      else
+      {
+        mat.block_pc_group_ = -1;
+        std::cout << "  the block-jacobi preconditioner exceeds the memory limit, "
+                     "using jacobi\n";
+      }
+    }
+  }
 }
 
-#endif // KRON_MODE_GLOBAL_BLOCK
+template<typename precision>
+block_multilevel_preconditioner<precision>::block_multilevel_preconditioner(
+    PDE<precision> const &pde, options const &program_options,
+    block_global_kron_matrix<precision> const &fine,
+    connect_1d const *volumes, connect_1d const *fluxes, int64_t max_coarse_size)
+    : fine_size_(fine.num_active())
+{
+  int const num_dimensions = pde.num_dims();
+  int64_t const block_size = fine.block_size();
+
+  // the 1D level of index i is the number of bits of i
+  auto total_level = [&](int const *cell) -> int {
+    int l = 0;
+    for (int d = 0; d < num_dimensions; d++)
+      for (int i = cell[d]; i > 0; i >>= 1)
+        l++;
+    return l;
+  };
+
+  // the cells of the fine level in grid order
+  int64_t num_cells = fine.num_active() / block_size;
+  vector2d<int> cells(num_dimensions, num_cells);
+  for (int64_t c = 0; c < num_cells; c++)
+    std::copy_n(fine.get_cells()[c], num_dimensions, cells[fine.grid_cell(c)]);
+
+  while (num_cells * block_size > max_coarse_size)
+  {
+    int max_level = 0;
+    for (int64_t c = 0; c < num_cells; c++)
+      max_level = std::max(max_level, total_level(cells[c]));
+
+    coarse_level level;
+    for (int64_t c = 0; c < num_cells; c++)
+      if (total_level(cells[c]) < max_level)
+        level.parent.push_back(c);
+
+    int64_t const num_coarse = static_cast<int64_t>(level.parent.size());
+    if (num_coarse == 0)
+      break;
+
+    vector2d<int> coarse(num_dimensions, num_coarse);
+    for (int64_t c = 0; c < num_coarse; c++)
+      std::copy_n(cells[level.parent[c]], num_dimensions, coarse[c]);
+
+    level.workspace = std::make_unique<kronmult::block_global_workspace<precision>>();
+    level.mat       = make_block_global_kron_matrix(pde, coarse, program_options,
+                                                    volumes, fluxes, level.workspace.get());
+    coarse_.push_back(std::move(level));
+
+    cells     = std::move(coarse);
+    num_cells = num_coarse;
+  }
+
+  num_levels_ = 1 + static_cast<int>(coarse_.size());
+  res_.resize(num_levels_);
+  sol_.resize(num_levels_);
+  prod_.resize(num_levels_);
+  for (int l = 0; l < num_levels_; l++)
+  {
+    res_[l].resize(level_size(l));
+    sol_[l].resize(level_size(l));
+    prod_[l].resize(level_size(l));
+  }
+}
+
+template<typename precision>
+void block_multilevel_preconditioner<precision>::set_coefficients(
+    PDE<precision> const &pde, options const &program_options, imex_flag imex,
+    block_global_kron_matrix<precision> const &fine)
+{
+  imex_ = static_cast<int>(imex);
+
+  std::vector<precision> const *finer =
+      &fine.template get_diagonal_preconditioner<resource::host>();
+  expect(static_cast<int64_t>(finer->size()) == fine_size_);
+
+  int64_t const block_size = fine.block_size();
+  for (auto &level : coarse_)
+  {
+    set_specific_coefficients(pde, program_options, imex, level.mat);
+
+    int64_t const num_cells = static_cast<int64_t>(level.parent.size());
+    level.diag.resize(num_cells * block_size);
+    for (int64_t c = 0; c < num_cells; c++)
+      std::copy_n(finer->data() + level.parent[c] * block_size, block_size,
+                  level.diag.data() + c * block_size);
+    finer = &level.diag;
+  }
+  // the coarse operator changed
+  lu_.clear();
+}
+
+template<typename precision>
+void block_multilevel_preconditioner<precision>::apply(
+    block_global_kron_matrix<precision> const &fine, precision dt, precision x[]) const
+{
+  expect(is_set());
+  std::copy_n(x, fine_size_, res_[0].data());
+  vcycle(fine, 0, dt, res_[0].data(), x);
+}
+
+static int smoothing_steps = std::getenv("ML_SMOOTH") ? std::atoi(std::getenv("ML_SMOOTH")) : 1;
+template<typename precision>
+void block_multilevel_preconditioner<precision>::vcycle(
+    block_global_kron_matrix<precision> const &fine, int l, precision dt,
+    precision const r[], precision x[]) const
+{
+  int64_t const n = level_size(l);
+
+  if (l == num_levels_ - 1)
+  { // coarsest level, direct solve with the dense LU factors
+    int const nc = static_cast<int>(n);
+    if (lu_.empty() or dt != lu_dt_)
+    {
+      lu_.resize(n * n);
+      lu_pivots_.resize(n);
+      std::vector<precision> e(n);
+      for (int64_t j = 0; j < n; j++)
+      {
+        e[j] = 1;
+        apply_level(fine, l, dt, e.data(), lu_.data() + j * n);
+        e[j] = 0;
+      }
+      int const info = lib_dispatch::getrf(nc, nc, lu_.data(), nc, lu_pivots_.data());
+      expect(info == 0);
+      lu_dt_ = dt;
+    }
+    std::copy_n(r, n, x);
+    lib_dispatch::getrs('N', nc, 1, lu_.data(), nc, lu_pivots_.data(), x, nc);
+    return;
+  }
+
+  std::vector<precision> const &diag =
+      (l == 0) ? fine.template get_diagonal_preconditioner<resource::host>()
+               : coarse_[l - 1].diag;
+  precision *const t = prod_[l].data();
+
+  static precision const womega = std::getenv("ML_W") ? std::atof(std::getenv("ML_W")) : omega;
+  static bool const frelax = std::getenv("ML_F") != nullptr;
+  std::vector<char> fmask(n, 1);
+  if (frelax)
+    for (auto p : coarse_[l].parent)
+      std::fill_n(fmask.data() + p * fine.block_size(), fine.block_size(), 0);
+  auto smooth = [&]() -> void {
+    apply_level(fine, l, dt, x, t);
+#pragma omp parallel for
+    for (int64_t i = 0; i < n; i++)
+      if (fmask[i])
+        x[i] += womega * (r[i] - t[i]) / (precision{1} - dt * diag[i]);
+  };
+
+  // pre-smoothing, starting from zero
+#pragma omp parallel for
+  for (int64_t i = 0; i < n; i++)
+    x[i] = (fmask[i]) ? womega * r[i] / (precision{1} - dt * diag[i]) : 0;
+  for (int s = 1; s < smoothing_steps; s++)
+    smooth();
+
+  // coarse grid correction, the restriction selects the coarse cells
+  apply_level(fine, l, dt, x, t);
+
+  int64_t const block_size = fine.block_size();
+  std::vector<int64_t> const &parent = coarse_[l].parent;
+  int64_t const num_coarse = static_cast<int64_t>(parent.size());
+  precision *const rc = res_[l + 1].data();
+  precision *const xc = sol_[l + 1].data();
+#pragma omp parallel for
+  for (int64_t c = 0; c < num_coarse; c++)
+    for (int64_t j = 0; j < block_size; j++)
+    {
+      int64_t const i = parent[c] * block_size + j;
+      rc[c * block_size + j] = r[i] - t[i];
+    }
+
+  vcycle(fine, l + 1, dt, rc, xc);
+
+#pragma omp parallel for
+  for (int64_t c = 0; c < num_coarse; c++)
+    for (int64_t j = 0; j < block_size; j++)
+      x[parent[c] * block_size + j] += xc[c * block_size + j];
+
+  // post-smoothing
+  for (int s = 0; s < smoothing_steps; s++)
+    smooth();
+}
 
 #ifdef ASGARD_ENABLE_DOUBLE
 template std::vector<int> get_used_terms(PDE<double> const &pde, options const &opts,
@@ -1737,8 +2480,6 @@ template std::vector<int> get_used_terms(PDE<double> const &pde, options const &
 
 template vector2d<int> get_cells(int, adapt::distributed_grid<double> const &);
 
-#ifdef KRON_MODE_GLOBAL
-#ifdef KRON_MODE_GLOBAL_BLOCK
 template class block_global_kron_matrix<double>;
 template void block_global_kron_matrix<double>::apply<resource::host>(
     imex_flag, double, double *) const;
@@ -1746,13 +2487,23 @@ template void block_global_kron_matrix<double>::apply<resource::host>(
 template block_global_kron_matrix<double>
 make_block_global_kron_matrix<double>(PDE<double> const &,
                                       adapt::distributed_grid<double> const &,
+                                      options const &,
                                       connect_1d const *, connect_1d const *,
                                       kronmult::block_global_workspace<double> *workspace);
 template void set_specific_mode<double>(PDE<double> const &,
                                         adapt::distributed_grid<double> const &,
                                         options const &, imex_flag const,
                                         block_global_kron_matrix<double> &);
-#else
+template block_global_kron_matrix<double>
+make_block_global_kron_matrix<double>(PDE<double> const &, vector2d<int>,
+                                      options const &,
+                                      connect_1d const *, connect_1d const *,
+                                      kronmult::block_global_workspace<double> *workspace);
+template void set_specific_coefficients<double>(PDE<double> const &, options const &,
+                                                imex_flag const,
+                                                block_global_kron_matrix<double> &);
+template class block_multilevel_preconditioner<double>;
+
 template global_kron_matrix<double>
 make_global_kron_matrix(PDE<double> const &,
                         adapt::distributed_grid<double> const &,
@@ -1772,9 +2523,7 @@ template void global_kron_matrix<double>::apply<resource::host>(
 template void global_kron_matrix<double>::apply<resource::device>(
     imex_flag, double, double const *, double, double *) const;
 #endif
-#endif // KRON_MODE_GLOBAL_BLOCK
 
-#else // KRON_MODE_GLOBAL
 template local_kronmult_matrix<double>
 make_local_kronmult_matrix<double>(
     PDE<double> const &, adapt::distributed_grid<double> const &,
@@ -1789,7 +2538,6 @@ compute_mem_usage<double>(PDE<double> const &,
                           options const &, imex_flag const, kron_sparse_cache &,
                           int, int64_t, bool);
 #endif
-#endif
 
 #ifdef ASGARD_ENABLE_FLOAT
 template std::vector<int> get_used_terms(PDE<float> const &pde, options const &opts,
@@ -1797,8 +2545,6 @@ template std::vector<int> get_used_terms(PDE<float> const &pde, options const &o
 
 template vector2d<int> get_cells(int, adapt::distributed_grid<float> const &);
 
-#ifdef KRON_MODE_GLOBAL
-#ifdef KRON_MODE_GLOBAL_BLOCK
 template class block_global_kron_matrix<float>;
 
 template void block_global_kron_matrix<float>::apply<resource::host>(
@@ -1807,13 +2553,23 @@ template void block_global_kron_matrix<float>::apply<resource::host>(
 template block_global_kron_matrix<float>
 make_block_global_kron_matrix<float>(PDE<float> const &,
                                      adapt::distributed_grid<float> const &,
+                                     options const &,
                                      connect_1d const *, connect_1d const *,
                                      kronmult::block_global_workspace<float> *workspace);
 template void set_specific_mode<float>(PDE<float> const &,
                                        adapt::distributed_grid<float> const &,
                                        options const &, imex_flag const,
                                        block_global_kron_matrix<float> &);
-#else
+template block_global_kron_matrix<float>
+make_block_global_kron_matrix<float>(PDE<float> const &, vector2d<int>,
+                                     options const &,
+                                     connect_1d const *, connect_1d const *,
+                                     kronmult::block_global_workspace<float> *workspace);
+template void set_specific_coefficients<float>(PDE<float> const &, options const &,
+                                               imex_flag const,
+                                               block_global_kron_matrix<float> &);
+template class block_multilevel_preconditioner<float>;
+
 template global_kron_matrix<float>
 make_global_kron_matrix(PDE<float> const &,
                         adapt::distributed_grid<float> const &,
@@ -1833,9 +2589,7 @@ template void global_kron_matrix<float>::apply<resource::host>(
 template void global_kron_matrix<float>::apply<resource::device>(
     imex_flag, float, float const *, float, float *) const;
 #endif
-#endif // KRON_MODE_GLOBAL_BLOCK
 
-#else // KRON_MODE_GLOBAL
 template local_kronmult_matrix<float>
 make_local_kronmult_matrix<float>(
     PDE<float> const &, adapt::distributed_grid<float> const &,
@@ -1849,6 +2603,5 @@ compute_mem_usage<float>(PDE<float> const &,
                          options const &, imex_flag const, kron_sparse_cache &,
                          int, int64_t, bool);
 #endif
-#endif
 
 } // namespace asgard
@@ -7,6 +7,7 @@
 #include "asgard_vector.hpp"
 #include "distribution.hpp"
 #include "elements.hpp"
+#include "lib_dispatch.hpp"
 #include "pde.hpp"
 
 #include "./device/asgard_kronmult.hpp"
@@ -30,9 +31,8 @@ template<typename precision>
 vector2d<int> get_cells(int num_dimensions,
                         adapt::distributed_grid<precision> const &dis_grid);
 
-#ifndef KRON_MODE_GLOBAL
 // using LOCAL kronmult, can be parallelised using MPI but much more expensive
-// then the global modes below
+// then the global modes below, selected with kron_backend::local
 // also has the ability to limit memory and do some operations out-of-core
 // hence it is currently the most memory conserving mode
 
@@ -102,7 +102,106 @@ struct kron_sparse_cache
   std::vector<int> cconnect;
   //! \brief Number of non-zeros in the kronmult sparse matrix
   int64_t num_nonz;
+  /*!
+   * \brief Use the packed index list of kronmult::cpu_sparse_packed()
+   *
+   * Set by compute_mem_usage() in the CPU case, if the rows of cells1d
+   * are short enough for the 16-bit offsets, reset to false before
+   * making the matrix to force the full list.
+   */
+  bool packed_index = false;
+};
+
+#ifdef ASGARD_USE_CPU_MEM_LIMIT
+/*!
+ * \brief Scratch file that holds the index chunks of the sparse local kronmult
+ *
+ * Used in the CPU out-of-core mode, when the index lists do not fit
+ * in the memory limit. The chunks are appended to an unlinked temporary
+ * file (in TMPDIR) and then the file is memory-mapped, only the chunks
+ * that are prefetched or in use need to be resident in RAM.
+ * Each chunk holds the row pointers, the column indexes and the indexes
+ * of the coefficient matrices, in the format used by kronmult::cpu_sparse()
+ * or kronmult::cpu_sparse_packed().
+ */
+class ooc_index_file
+{
+public:
+  //! \brief Creates an empty file, no scratch space is opened
+  ooc_index_file() = default;
+  //! \brief Unmaps and closes the file
+  ~ooc_index_file();
+
+  ooc_index_file(ooc_index_file const &) = delete;
+  ooc_index_file &operator=(ooc_index_file const &) = delete;
+  //! \brief Takes over the file of the other object
+  ooc_index_file(ooc_index_file &&other) { *this = std::move(other); }
+  //! \brief Swaps the files, the old file is released with the other object
+  ooc_index_file &operator=(ooc_index_file &&other)
+  {
+    std::swap(fd_, other.fd_);
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(chunks_, other.chunks_);
+    return *this;
+  }
+
+  //! \brief Writes the next chunk into the file, cannot be called after map()
+  void append(fk::vector<int> const &row_indx, fk::vector<int> const &col_indx,
+              fk::vector<int> const &index_A);
+  //! \brief Maps the file into memory, call once after the last append()
+  void map();
+
+  //! \brief Returns true if no chunks have been written
+  bool empty() const { return chunks_.empty(); }
+  //! \brief Returns the number of chunks
+  int64_t num_chunks() const { return static_cast<int64_t>(chunks_.size()); }
+  //! \brief Returns the number of rows in the chunk
+  int num_rows(int64_t c) const { return chunks_[c].num_rows; }
+  //! \brief Returns the total number of (row, col) pairs in all chunks
+  int64_t num_pairs() const
+  {
+    int64_t total = 0;
+    for (auto const &c : chunks_)
+      total += c.num_cols;
+    return total;
+  }
+  //! \brief Returns the row pointers of the chunk, num_rows() + 1 entries
+  int const *row_indx(int64_t c) const { return pntr(c); }
+  //! \brief Returns the column indexes of the chunk
+  int const *col_indx(int64_t c) const { return pntr(c) + chunks_[c].num_rows + 1; }
+  //! \brief Returns the indexes of the coefficient matrices for the chunk
+  int const *index_A(int64_t c) const
+  {
+    return col_indx(c) + chunks_[c].num_cols;
+  }
+
+  //! \brief Asks the kernel to start reading the chunk, does not block
+  void prefetch(int64_t c) const;
+  //! \brief Drops the resident pages of the chunk, the data stays in the file
+  void release(int64_t c) const;
+
+private:
+  //! \brief Location of a chunk in the file, offsets are aligned to a page
+  struct chunk
+  {
+    int64_t offset;
+    int64_t bytes;
+    int num_rows;
+    int num_cols;
+    int64_t num_iA;
+  };
+  int const *pntr(int64_t c) const
+  {
+    return reinterpret_cast<int const *>(static_cast<char const *>(data_) + chunks_[c].offset);
+  }
+
+  int fd_       = -1;
+  void *data_   = nullptr;
+  int64_t size_ = 0;
+  std::vector<chunk> chunks_;
 };
+#endif
 
 /*!
  * \brief Contains persistent data for a kronmult operation.
@@ -292,6 +391,9 @@ public:
    *         loaded on the GPU and multi_mode must be set to device
    * \tparam input_mode the mode of the coefficient matrices is always host
    *         for the CPU and device when CUDA is enabled
+   *
+   * If packed_index is set, the index lists use the format of
+   * kronmult::cpu_sparse_packed(), CPU only.
    */
   template<resource multi_mode, resource input_mode>
   local_kronmult_matrix(
@@ -301,15 +403,39 @@ public:
       std::vector<fk::vector<int, mem_type::owner, multi_mode>> &&col_indx,
       std::vector<fk::vector<int, mem_type::owner, multi_mode>> &&list_index_A,
       fk::vector<precision, mem_type::owner, input_mode> &&values_A,
-      std::vector<precision> &&prec)
+      std::vector<precision> &&prec, bool packed_index = false)
       : local_kronmult_matrix(num_dimensions, kron_size, num_rows, num_cols,
                               num_terms, 0, std::move(row_indx), std::move(col_indx),
                               std::move(list_index_A), std::move(values_A),
-                              std::move(prec))
+                              std::move(prec), packed_index)
   {
     expect(not(list_row_indx_.empty() and list_col_indx_.empty()));
   }
 
+#ifdef ASGARD_USE_CPU_MEM_LIMIT
+  /*!
+   * \brief Constructs a sparse matrix with the index chunks kept in a scratch file.
+   *
+   * Used when the index lists do not fit in the memory limit,
+   * the chunks are streamed from the file in each call to apply().
+   */
+  local_kronmult_matrix(int num_dimensions, int kron_size, int num_rows,
+                        int num_cols, int num_terms, ooc_index_file &&ooc,
+                        fk::vector<precision> &&values_A,
+                        std::vector<precision> &&prec, bool packed_index)
+      : num_dimensions_(num_dimensions), kron_size_(kron_size),
+        num_rows_(num_rows), num_cols_(num_cols), num_terms_(num_terms),
+        tensor_size_(fm::ipow(kron_size, num_dimensions)), list_row_stride_(0),
+        ooc_(std::move(ooc)), packed_index_(packed_index),
+        vA(std::move(values_A)), row_offset_(0), col_offset_(0),
+        num_1d_blocks_(0), pre_con_(std::move(prec))
+  {
+    expect(not ooc_.empty());
+    flops_ = tensor_size_ * kron_size_ * num_dimensions_ * num_terms_ *
+             ooc_.num_pairs();
+  }
+#endif
+
 #ifdef ASGARD_USE_CUDA
   //! \brief Set the workspace memory for x and y
   void
@@ -469,28 +595,155 @@ public:
                   "CUDA not enabled, only resource::host is allowed for "
                   "the kronmult_matrix::apply() template parameter");
 
-    if (is_dense())
+    if (not scalar_vals_.empty())
+    {
+      if (is_dense())
+      {
+        lib_dispatch::gemv('n', num_rows_, num_cols_, alpha,
+                           scalar_vals_.data(), num_rows_, x, 1, beta, y, 1);
+      }
+      else
+      {
+        int64_t row_offset = 0;
+        int64_t offset     = 0;
+        for (size_t i = 0; i < list_row_indx_.size(); i++)
+        {
+          int const rows = list_row_indx_[i].size() - 1;
+          lib_dispatch::sparse_gemv('n', rows, num_cols_,
+                                    list_col_indx_[i].size(),
+                                    list_row_indx_[i].data(),
+                                    list_col_indx_[i].data(),
+                                    scalar_vals_.data() + offset, alpha, x,
+                                    beta, y + row_offset);
+          row_offset += rows;
+          offset += list_col_indx_[i].size();
+        }
+      }
+    }
+    else if (is_dense())
     {
       kronmult::cpu_dense(num_dimensions_, kron_size_, num_rows_, num_cols_,
                           num_terms_, elem_.data(), row_offset_, col_offset_,
                           term_pntr_.data(), num_1d_blocks_, alpha, x, beta, y);
     }
+#ifdef ASGARD_USE_CPU_MEM_LIMIT
+    else if (not ooc_.empty())
+    {
+      // the kernel reads chunk c + 1 from the file while chunk c is computed
+      ooc_.prefetch(0);
+      int64_t row_offset = 0;
+      for (int64_t c = 0; c < ooc_.num_chunks(); c++)
+      {
+        if (c + 1 < ooc_.num_chunks())
+          ooc_.prefetch(c + 1);
+        cpu_sparse(ooc_.num_rows(c), ooc_.row_indx(c), ooc_.col_indx(c),
+                   ooc_.index_A(c), alpha, x, beta,
+                   y + row_offset * tensor_size_);
+        row_offset += ooc_.num_rows(c);
+        ooc_.release(c);
+      }
+    }
+#endif
     else
     {
       int64_t row_offset = 0;
       for (size_t i = 0; i < list_row_indx_.size(); i++)
       {
-        kronmult::cpu_sparse(num_dimensions_, kron_size_,
-                             list_row_indx_[i].size() - 1,
-                             list_row_indx_[i].data(), list_col_indx_[i].data(),
-                             num_terms_, list_iA[i].data(), vA.data(), alpha, x,
-                             beta, y + row_offset * tensor_size_);
+        cpu_sparse(list_row_indx_[i].size() - 1, list_row_indx_[i].data(),
+                   list_col_indx_[i].data(), list_iA[i].data(), alpha, x, beta,
+                   y + row_offset * tensor_size_);
         row_offset += list_row_indx_[i].size() - 1;
       }
     }
 #endif
   }
 
+  /*!
+   * \brief Computes y[v] = alpha * kronmult_matrix * x[v] + beta * y[v]
+   *
+   * The vectors are on the host, v goes from 0 to num_rhs - 1.
+   * With n = 1 and combined dense matrix, the vectors are packed together
+   * and the product is done with one call to gemm, otherwise the vectors
+   * are processed one at a time.
+   */
+  void apply_block(int num_rhs, precision alpha, precision const *const x[],
+                   precision beta, precision *const y[]) const
+  {
+#ifndef ASGARD_USE_CUDA
+    if (num_rhs > 1 and not scalar_vals_.empty() and is_dense())
+    {
+      int64_t const isize = input_size();
+      int64_t const osize = output_size();
+      std::vector<precision> xblock(isize * num_rhs);
+      std::vector<precision> yblock(osize * num_rhs);
+      for (int v = 0; v < num_rhs; v++)
+      {
+        std::copy_n(x[v], isize, xblock.data() + v * isize);
+        if (beta != 0)
+          std::copy_n(y[v], osize, yblock.data() + v * osize);
+      }
+      lib_dispatch::gemm('n', 'n', num_rows_, num_rhs, num_cols_, alpha,
+                         scalar_vals_.data(), num_rows_, xblock.data(),
+                         num_cols_, beta, yblock.data(), num_rows_);
+      for (int v = 0; v < num_rhs; v++)
+        std::copy_n(yblock.data() + v * osize, osize, y[v]);
+      return;
+    }
+#endif
+    for (int v = 0; v < num_rhs; v++)
+      apply(alpha, x[v], beta, y[v]);
+  }
+
+#ifndef ASGARD_USE_CUDA
+  /*!
+   * \brief Combines the scalar products for n = 1, CPU only
+   *
+   * The Kronecker products with n = 1 are products of scalars,
+   * the sum over all terms is precomputed into a dense matrix (dense mode)
+   * or into the values of a row-compressed matrix (sparse mode).
+   * Then apply() calls gemv or the sparse_gemv from lib_dispatch.
+   * The combined values are recomputed when the coefficients are updated.
+   * Has no effect for n > 1 or if the sparse index lists are packed
+   * or out-of-core.
+   */
+  void combine_scalar_products()
+  {
+    if (kron_size_ != 1 or num_terms_ == 0 or packed_index_)
+      return;
+#ifdef ASGARD_USE_CPU_MEM_LIMIT
+    if (not ooc_.empty())
+      return;
+#endif
+    if (is_dense())
+    {
+      scalar_vals_ = fk::vector<precision>(int64_t{num_rows_} * num_cols_);
+      kronmult::cpu_n0_combine(num_dimensions_, num_rows_, num_cols_,
+                               num_terms_, elem_.data(), row_offset_,
+                               col_offset_, term_pntr_.data(), num_1d_blocks_,
+                               scalar_vals_.data());
+    }
+    else
+    {
+      int64_t num_pairs = 0;
+      for (auto const &c : list_col_indx_)
+        num_pairs += c.size();
+      scalar_vals_ = fk::vector<precision>(num_pairs);
+
+      int64_t offset = 0;
+      for (size_t i = 0; i < list_row_indx_.size(); i++)
+      {
+        kronmult::cpu_n0_combine(num_dimensions_, list_row_indx_[i].size() - 1,
+                                 list_row_indx_[i].data(), num_terms_,
+                                 list_iA[i].data(), vA.data(),
+                                 scalar_vals_.data() + offset);
+        offset += list_col_indx_[i].size();
+      }
+    }
+  }
+  //! \brief Returns true if n = 1 and the scalar products are combined
+  bool is_scalar_combined() const { return not scalar_vals_.empty(); }
+#endif
+
   //! \brief Returns the number of kron-products
   int64_t num_batch() const { return int64_t{num_rows_} * int64_t{num_cols_}; }
 
@@ -519,6 +772,10 @@ public:
   //! \brief Defined if the matrix is dense or sparse
   bool is_dense() const
   {
+#ifdef ASGARD_USE_CPU_MEM_LIMIT
+    if (not ooc_.empty())
+      return false;
+#endif
     return (row_indx_.empty() and list_row_indx_.empty());
   }
 
@@ -539,6 +796,10 @@ public:
     expect(num_dimensions_ > 0);
     expect(values_A.size() == vA.size());
     vA = std::move(values_A);
+#ifndef ASGARD_USE_CUDA
+    if (not scalar_vals_.empty())
+      combine_scalar_products();
+#endif
   }
   //! \brief Update coefficients
   template<resource input_mode>
@@ -567,6 +828,8 @@ public:
 #else
     for (int t = 0; t < num_terms_; t++)
       term_pntr_[t] = terms_[t].data();
+    if (not scalar_vals_.empty())
+      combine_scalar_products();
 #endif
   }
 
@@ -578,10 +841,21 @@ public:
 #ifdef ASGARD_USE_CUDA
     return (iA.size() > 0);
 #else
+#ifdef ASGARD_USE_CPU_MEM_LIMIT
+    if (not ooc_.empty())
+      return (ooc_.num_chunks() == 1);
+#endif
     return (iA.size() > 0 or list_iA.size() == 1);
 #endif
   }
 
+#ifdef ASGARD_USE_CPU_MEM_LIMIT
+  //! \brief Returns true if the index chunks are streamed from a scratch file
+  bool is_out_of_core() const { return not ooc_.empty(); }
+#endif
+  //! \brief Returns true if the index lists use the packed format
+  bool is_packed_index() const { return packed_index_; }
+
   //! \brief Returns the preconditioner.
   template<resource rec>
   auto const &get_diagonal_preconditioner() const
@@ -613,13 +887,14 @@ private:
           &&col_indx,
       std::vector<fk::vector<int, mem_type::owner, multi_mode>> &&list_index_A,
       fk::vector<precision, mem_type::owner, input_mode> &&values_A,
-      std::vector<precision> &&prec)
+      std::vector<precision> &&prec, bool packed_index)
       : num_dimensions_(num_dimensions), kron_size_(kron_size),
         num_rows_(num_rows), num_cols_(num_cols), num_terms_(num_terms),
         tensor_size_(1), list_row_stride_(list_row_stride),
         list_row_indx_(std::move(row_indx)),
         list_col_indx_(std::move(col_indx)), list_iA(std::move(list_index_A)),
-        vA(std::move(values_A)), pre_con_(std::move(prec))
+        packed_index_(packed_index), vA(std::move(values_A)),
+        pre_con_(std::move(prec))
   {
 #ifdef ASGARD_USE_CUDA
 #ifdef ASGARD_USE_GPU_MEM_LIMIT
@@ -646,11 +921,32 @@ private:
 
     tensor_size_ = fm::ipow(kron_size_, num_dimensions_);
 
+#ifdef ASGARD_USE_CUDA
+    expect(not packed_index_);
+#endif
+
+    // the packed lists are smaller, count the (row, col) pairs instead
     flops_ = 0;
-    for (auto const &a : list_iA)
-      flops_ += static_cast<int64_t>(a.size());
-    flops_ *= int64_t{tensor_size_} * kron_size_;
+    for (auto const &c : list_col_indx_)
+      flops_ += static_cast<int64_t>(c.size());
+    flops_ *= int64_t{tensor_size_} * kron_size_ * num_dimensions_ * num_terms_;
+  }
+
+#ifndef ASGARD_USE_CUDA
+  //! \brief Calls the CPU kernel that matches the format of the index list
+  void cpu_sparse(int num_rows, int const pntr[], int const indx[],
+                  int const index_A[], precision alpha, precision const x[],
+                  precision beta, precision y[]) const
+  {
+    if (packed_index_)
+      kronmult::cpu_sparse_packed(num_dimensions_, kron_size_, num_rows, pntr,
+                                  indx, num_terms_, index_A, vA.data(), alpha,
+                                  x, beta, y);
+    else
+      kronmult::cpu_sparse(num_dimensions_, kron_size_, num_rows, pntr, indx,
+                           num_terms_, index_A, vA.data(), alpha, x, beta, y);
   }
+#endif
 
   int num_dimensions_;
   int kron_size_; // i.e., n - size of the matrices
@@ -697,6 +993,17 @@ private:
   std::vector<fk::vector<int, mem_type::owner, multi_data_mode>> list_col_indx_;
   std::vector<fk::vector<int, mem_type::owner, multi_data_mode>> list_iA;
 
+#ifdef ASGARD_USE_CPU_MEM_LIMIT
+  // out-of-core mode, the chunks of the multi call are kept in a file
+  ooc_index_file ooc_;
+#endif
+  // the CPU index lists use the format of kronmult::cpu_sparse_packed()
+  bool packed_index_ = false;
+#ifndef ASGARD_USE_CUDA
+  // n = 1, the scalar products combined into a dense or sparse matrix
+  fk::vector<precision> scalar_vals_;
+#endif
+
   // values of the kron matrices (loaded form the coefficients)
   fk::vector<precision, mem_type::owner, data_mode> vA;
 
@@ -789,13 +1096,9 @@ compute_mem_usage(PDE<P> const &pde, adapt::distributed_grid<P> const &grid,
                   kron_sparse_cache &spcache, int memory_limit_MB = 0,
                   int64_t index_limit = 2147483646, bool force_sparse = false);
 
-#endif // end the ifndef KRON_MODE_GLOBAL
-
-#ifdef KRON_MODE_GLOBAL
-#ifndef KRON_MODE_GLOBAL_BLOCK
 // using GLOBAL kronmult where the explicitly form the sparse matrices
 // can be used with the cuSparse library (in CUDA mode)
-// will be replaced by the block global mode
+// will be replaced by the block global mode, selected with kron_backend::global
 
 // forward declaration that allows set/update methods to be friends
 template<typename precision>
@@ -1041,14 +1344,15 @@ make_global_kron_matrix(PDE<precision> const &pde,
                         options const &program_options);
 
 /*!
- * \brief Holds a list of matrices used for time-stepping.
+ * \brief Holds a list of matrices used for time-stepping, global kronmult.
  *
  * There are multiple types of matrices based on the time-stepping and the
  * different terms being used. Matrices are grouped in one object so they can go
  * as a set and reduce the number of matrix making.
+ * Used by kron_operators when the backend is kron_backend::global.
  */
 template<typename precision>
-struct kron_operators
+struct global_kron_operators
 {
   template<resource rec = resource::host>
   void apply(imex_flag entry, precision alpha, precision const x[], precision beta, precision y[]) const
@@ -1062,6 +1366,19 @@ struct kron_operators
   {
     kglobal.template apply<rec>(entry, alpha, x, beta, y);
   }
+
+  void apply_block(imex_flag entry, int num_rhs, precision alpha, precision const *const x[],
+                   precision beta, precision *const y[]) const
+  {
+    apply_block(entry, 0, num_rhs, alpha, x, beta, y);
+  }
+  //! \brief Apply the given matrix entry to num_rhs vectors, one at a time
+  void apply_block(imex_flag entry, precision time, int num_rhs, precision alpha,
+                   precision const *const x[], precision beta, precision *const y[]) const
+  {
+    for (int v = 0; v < num_rhs; v++)
+      apply(entry, time, alpha, x[v], beta, y[v]);
+  }
   int64_t flops(imex_flag entry) const
   {
     return kglobal.flops(entry);
@@ -1134,11 +1451,9 @@ private:
   gpu::vector<std::byte> gpu_sparse_buffer;
 #endif
 };
-#endif // end ifndef KRON_MODE_GLOBAL_BLOCK
-#endif // end ifdef KRON_MODE_GLOBAL
 
-#ifdef KRON_MODE_GLOBAL_BLOCK
 // using BLOCK-GLOBAL kronmult, the fastest method on the cpu and very memory conservative
+// selected with kron_backend::block_global
 
 template<typename precision>
 class block_global_kron_matrix;
@@ -1150,6 +1465,11 @@ void set_specific_mode(
     options const &program_options, imex_flag const imex,
     block_global_kron_matrix<precision> &mat);
 
+template<typename precision>
+void set_specific_coefficients(PDE<precision> const &pde,
+                               options const &program_options, imex_flag const imex,
+                               block_global_kron_matrix<precision> &mat);
+
 template<typename precision>
 class block_global_kron_matrix
 {
@@ -1160,19 +1480,23 @@ public:
 
   block_global_kron_matrix(int64_t num_active, int64_t num_padded,
                            int num_dimensions, int blockn, int64_t block_size,
-                           vector2d<int> &&ilist, dimension_sort &&dsort,
+                           vector2d<int> &&ilist, std::vector<int> &&cell_order,
+                           dimension_sort &&dsort,
                            std::vector<kronmult::permutes> &&perms, std::vector<int> &&flux_dir,
                            connect_1d const *conn_volumes, connect_1d const *conn_full,
                            kronmult::block_global_workspace<precision> *workspace)
       : num_active_(num_active), num_padded_(num_padded),
         num_dimensions_(num_dimensions), blockn_(blockn), block_size_(block_size),
-        ilist_(std::move(ilist)), dsort_(std::move(dsort)), perms_(std::move(perms)),
+        ilist_(std::move(ilist)), cell_order_(std::move(cell_order)),
+        dsort_(std::move(dsort)), perms_(std::move(perms)),
         flux_dir_(std::move(flux_dir)), conn_volumes_(conn_volumes),
         conn_full_(conn_full), gvals_(flux_dir_.size() * num_dimensions_),
+        single_coeffs_(false),
+        tiles_(ilist_, perms_, block_size_ * static_cast<int64_t>(sizeof(precision))),
         workspace_(workspace)
   {
-    for (auto &f : flops_)
-      f = -1;
+    for (auto &r : roofline_)
+      r.flops = -1;
   }
 
   /*!
@@ -1191,6 +1515,32 @@ public:
    */
   template<resource rec>
   void apply(imex_flag etype, precision alpha, precision *y) const;
+  /*!
+   * \brief Computes y = x - dt * A * x, both x and y are in grid order
+   *
+   * Stages x in the workspace, does not include the interpolation terms.
+   * Used by the multilevel preconditioner.
+   */
+  void apply_shifted(imex_flag etype, precision dt, precision const x[],
+                     precision y[]) const
+  {
+    std::copy_n(x, num_active_, y);
+    if (not is_active(etype))
+      return;
+    load_active(x, workspace_->x.data());
+    apply<resource::host>(etype, -dt, y);
+  }
+  /*!
+   * \brief Multi-vector variant of apply(), works with num_rhs vectors
+   *
+   * Same assumptions as in apply(), except the padded values of the num_rhs
+   * vectors are stored interleaved in workspace->xrhs,
+   * i.e., entry i of vector v is at xrhs[i * num_rhs + v].
+   *
+   * Computes y[v] += alpha * A * x[v] for each vector v.
+   */
+  void apply_block(imex_flag etype, int num_rhs, precision alpha,
+                   precision *const y[]) const;
 
   operator bool() const { return (num_dimensions_ > 0); }
 
@@ -1201,8 +1551,13 @@ public:
       return true; // nothing to set, so we're OK
 
     for (int d = 0; d < num_dimensions_; d++)
-      if (not gvals_[terms.front() * num_dimensions_ + d].empty())
+    {
+      int const vid = terms.front() * num_dimensions_ + d;
+      if (single_coeffs_ and not gvals_single_[vid].empty())
         return true;
+      if (not gvals_[vid].empty())
+        return true;
+    }
 
     return false;
   }
@@ -1215,35 +1570,77 @@ public:
     return pre_con_;
   }
 
+  //! \brief Returns true if the block-Jacobi preconditioner has been set.
+  bool has_block_preconditioner() const { return (block_pc_group_ >= 0); }
+  /*!
+   * \brief Applies the block-Jacobi preconditioner, x = (I - dt * D)^{-1} x
+   *
+   * D holds the dense diagonal block of the implicit operator for each cell,
+   * taken from the diagonal 1D blocks of the coefficients.
+   * The blocks of I - dt * D are LU factored on the first call after the
+   * coefficients are updated, or when dt changes.
+   * The vector x is in grid order, i.e., same as in the solver.
+   */
+  void apply_block_preconditioner(precision dt, precision x[]) const;
+
   //! \brief Return the number of flops for the current matrix type
-  int64_t flops(imex_flag etype) const
+  int64_t flops(imex_flag etype) const { return roofline(etype).flops; }
+
+  //! \brief Return the flops, memory traffic and intensity for the current matrix type
+  kronmult::kron_roofline const &roofline(imex_flag etype) const
   {
     int i = static_cast<int>(etype);
-    if (flops_[i] == -1)
-    {
-      flops_[i] = kronmult::block_global_count_flops(
-          num_dimensions_, block_size_, ilist_, dsort_, perms_,
-          flux_dir_, *conn_volumes_, *conn_full_, term_groups_[i], *workspace_);
-      switch (etype)
-      {
-      case imex_flag::unspecified:
-        std::cout << "regular block-global kronmult matrix\n";
-        break;
-      case imex_flag::imex_explicit:
-        std::cout << "imex-explicit block-global kronmult matrix\n";
-        break;
-      case imex_flag::imex_implicit:
-        std::cout << "imex-implicit block-global kronmult matrix\n";
-        break;
-      };
-      std::cout << "   -- number of flops: " << flops_[i] * 1.E-9 << "Gflops\n";
-    }
-    return flops_[i];
+    if (roofline_[i].flops == -1)
+      roofline_[i] = kronmult::block_global_roofline<precision>(
+          num_dimensions_, blockn_, block_size_, ilist_, dsort_, perms_,
+          flux_dir_, *conn_volumes_, *conn_full_, term_groups_[i],
+          (single_coeffs_) ? sizeof(float) : sizeof(precision));
+    return roofline_[i];
   }
 
   vector2d<int> const &get_cells() const { return ilist_; };
   dimension_sort const &get_dsort() const { return dsort_; };
   int64_t num_active() const { return num_active_; }
+  //! \brief Returns the number of entries including the padding cells.
+  int64_t num_padded() const { return num_padded_; }
+
+  //! \brief Returns the number of entries in each cell.
+  int64_t block_size() const { return block_size_; }
+  //! \brief Returns the index in the grid of active cell c of the cell list.
+  int64_t grid_cell(int64_t c) const { return (cell_order_.empty()) ? c : cell_order_[c]; }
+  //! \brief Copies the active entries of x (grid order) into w (cell list order).
+  void load_active(precision const x[], precision w[]) const
+  {
+    if (cell_order_.empty())
+    {
+      std::copy_n(x, num_active_, w);
+      return;
+    }
+    int64_t const num_cells = num_active_ / block_size_;
+#pragma omp parallel for
+    for (int64_t c = 0; c < num_cells; c++)
+      std::copy_n(x + grid_cell(c) * block_size_, block_size_, w + c * block_size_);
+  }
+  //! \brief Computes y += alpha * w for the active entries, y is in grid order.
+  void add_active(precision alpha, precision const w[], precision y[]) const
+  {
+    if (cell_order_.empty())
+    {
+#pragma omp parallel for
+      for (int64_t i = 0; i < num_active_; i++)
+        y[i] += alpha * w[i];
+      return;
+    }
+    int64_t const num_cells = num_active_ / block_size_;
+#pragma omp parallel for
+    for (int64_t c = 0; c < num_cells; c++)
+    {
+      precision *const yc       = y + grid_cell(c) * block_size_;
+      precision const *const wc = w + c * block_size_;
+      for (int64_t j = 0; j < block_size_; j++)
+        yc[j] += alpha * wc[j];
+    }
+  }
 
   bool is_active(imex_flag etype) const
   {
@@ -1259,12 +1656,17 @@ public:
       adapt::distributed_grid<precision> const &dis_grid,
       options const &program_options, imex_flag const imex,
       block_global_kron_matrix<precision> &mat);
+  friend void set_specific_coefficients<precision>(
+      PDE<precision> const &pde, options const &program_options,
+      imex_flag const imex, block_global_kron_matrix<precision> &mat);
 
 private:
   int64_t num_active_, num_padded_;
   int num_dimensions_, blockn_;
   int64_t block_size_;
   vector2d<int> ilist_;
+  // if not empty, active cell c of ilist_ is cell cell_order_[c] of the grid
+  std::vector<int> cell_order_;
   dimension_sort dsort_;
   std::vector<kronmult::permutes> perms_;
   std::vector<int> flux_dir_;
@@ -1272,23 +1674,147 @@ private:
   connect_1d const *conn_full_;
 
   std::vector<std::vector<precision>> gvals_;
+  // coefficients stored in single precision, used if single_coeffs_ is set
+  std::vector<std::vector<float>> gvals_single_;
+  bool single_coeffs_;
   std::array<std::vector<int>, 3> term_groups_;
 
+  // cells grouped for the fused multi-direction sweeps
+  kronmult::sweep_tiles tiles_;
+
   mutable kronmult::block_global_workspace<precision> *workspace_;
 
-  mutable std::array<int64_t, num_imex_variants> flops_;
+  // flops == -1 means that the roofline has to be computed
+  mutable std::array<kronmult::kron_roofline, num_imex_variants> roofline_;
 
   // preconditioner
   std::vector<precision> pre_con_;
+
+  // block-Jacobi preconditioner, uses the terms of this imex group, -1 if not set
+  int block_pc_group_ = -1;
+  // LU factors and pivots of I - dt * D for each cell, empty if not factored
+  mutable precision block_pc_dt_ = 0;
+  mutable kronmult::first_touch_vector<precision> block_pc_;
+  mutable std::vector<int> block_pc_pivots_;
 };
 
 template<typename precision>
 block_global_kron_matrix<precision>
 make_block_global_kron_matrix(PDE<precision> const &pde,
                               adapt::distributed_grid<precision> const &dis_grid,
+                              options const &program_options,
+                              connect_1d const *volumes, connect_1d const *fluxes,
+                              kronmult::block_global_workspace<precision> *workspace);
+/*!
+ * \brief Makes the matrix for the given cells, instead of the cells of the grid
+ *
+ * The grid order of the matrix is the order of the cells.
+ */
+template<typename precision>
+block_global_kron_matrix<precision>
+make_block_global_kron_matrix(PDE<precision> const &pde, vector2d<int> cells,
+                              options const &program_options,
                               connect_1d const *volumes, connect_1d const *fluxes,
                               kronmult::block_global_workspace<precision> *workspace);
 
-#endif
+/*!
+ * \brief Multilevel preconditioner for I - dt * A over the sparse grid hierarchy
+ *
+ * Level 0 is the grid of the block-global matrix and level l + 1 keeps
+ * the cells of level l with total level (the sum of the 1D levels) below
+ * the largest total level of level l.
+ * In the hierarchical basis, the space of a coarse level is a subspace
+ * of the finer one, so the restriction and prolongation simply select
+ * and insert the coefficients of the coarse cells, and the coarse operator
+ * is the principal sub-matrix of the finer one, which is applied with
+ * the block-global kronmult on the coarse cells.
+ *
+ * The preconditioner is one V-cycle with damped Jacobi smoothing and
+ * a dense LU factorization on the coarsest level, which holds
+ * at most max_coarse_size entries.
+ */
+template<typename precision>
+class block_multilevel_preconditioner
+{
+public:
+  //! \brief Default size of the coarsest level, solved directly.
+  static constexpr int64_t default_max_coarse_size = 512;
+  //! \brief Damping of the Jacobi smoother.
+  static constexpr precision omega = precision{2} / precision{3};
+
+  block_multilevel_preconditioner() = default;
+  /*!
+   * \brief Makes the coarse levels for the cells of the fine matrix
+   *
+   * The coefficients must be loaded with set_coefficients().
+   */
+  block_multilevel_preconditioner(PDE<precision> const &pde, options const &program_options,
+                                  block_global_kron_matrix<precision> const &fine,
+                                  connect_1d const *volumes, connect_1d const *fluxes,
+                                  int64_t max_coarse_size = default_max_coarse_size);
+
+  //! \brief Loads the coefficients of the imex entry on all coarse levels.
+  void set_coefficients(PDE<precision> const &pde, options const &program_options,
+                        imex_flag imex, block_global_kron_matrix<precision> const &fine);
+
+  /*!
+   * \brief Applies one V-cycle, x = M^{-1} x
+   *
+   * The vector x is in the grid order of the fine matrix, which must be the
+   * one used in the constructor and set_coefficients().
+   */
+  void apply(block_global_kron_matrix<precision> const &fine, precision dt,
+             precision x[]) const;
+
+  //! \brief Returns true if the levels have been made.
+  operator bool() const { return (num_levels_ > 0); }
+  //! \brief Number of levels, including the fine one.
+  int num_levels() const { return num_levels_; }
+  //! \brief Returns the number of entries on level l.
+  int64_t level_size(int l) const
+  {
+    return (l == 0) ? fine_size_ : coarse_[l - 1].mat.num_active();
+  }
+  //! \brief Returns true if the coefficients have been loaded.
+  bool is_set() const { return (imex_ != -1); }
+
+private:
+  struct coarse_level
+  {
+    //! \brief Index of each cell in the cells of the finer level.
+    std::vector<int64_t> parent;
+    //! \brief Workspace of the coarse matrix, kept on the heap so the pointer is stable.
+    std::unique_ptr<kronmult::block_global_workspace<precision>> workspace;
+    block_global_kron_matrix<precision> mat;
+    //! \brief Diagonal of the operator A, restricted from the fine level.
+    std::vector<precision> diag;
+  };
+
+  //! \brief Recursive V-cycle on level l, the result goes into x.
+  void vcycle(block_global_kron_matrix<precision> const &fine, int l, precision dt,
+              precision const r[], precision x[]) const;
+  //! \brief Computes y = (I - dt * A_l) x
+  void apply_level(block_global_kron_matrix<precision> const &fine, int l, precision dt,
+                   precision const x[], precision y[]) const
+  {
+    if (l == 0)
+      fine.apply_shifted(static_cast<imex_flag>(imex_), dt, x, y);
+    else
+      coarse_[l - 1].mat.apply_shifted(static_cast<imex_flag>(imex_), dt, x, y);
+  }
+
+  int num_levels_   = 0;
+  int64_t fine_size_ = 0;
+  int imex_         = -1;
+  std::vector<coarse_level> coarse_;
+
+  // scratch vectors for each level: residual, solution and product
+  mutable std::vector<std::vector<precision>> res_, sol_, prod_;
+
+  // LU factors of the coarsest level, empty if not factored
+  mutable precision lu_dt_ = 0;
+  mutable std::vector<precision> lu_;
+  mutable std::vector<int> lu_pivots_;
+};
 
 } // namespace asgard
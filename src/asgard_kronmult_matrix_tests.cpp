@@ -552,6 +552,400 @@ TEMPLATE_TEST_CASE("testing global kron 5d, constant basis", "[gkron 5d]", test_
   test_global_kron<TestType>(5, l);
 }
 
+#ifdef KRON_MODE_GLOBAL_BLOCK
+template<typename precision>
+void test_block_tiles(int num_dimensions, int n, int level)
+{
+  std::minstd_rand park_miller(42);
+  std::uniform_real_distribution<precision> unif(-1.0, 1.0);
+
+  auto indexes = asgard::permutations::generate_lower_index_set(
+      num_dimensions,
+      [&](std::array<int, asgard::max_num_dimensions> const &index) -> bool {
+        int L = 0;
+        for (int i = 0; i < num_dimensions; i++)
+          L += int_log2(index[i]);
+        return (L <= level);
+      });
+
+  asgard::connect_1d conn(level, asgard::connect_1d::hierarchy::volume);
+
+  asgard::vector2d<int> ilist(num_dimensions, indexes);
+  asgard::dimension_sort dsort(ilist);
+
+  int64_t const block_size = asgard::fm::ipow(n, num_dimensions);
+
+  std::vector<std::vector<precision>> vals(num_dimensions);
+  for (auto &v : vals)
+  {
+    v.resize(n * n * conn.num_connections());
+    for (auto &a : v)
+      a = unif(park_miller);
+  }
+
+  std::vector<precision> x(block_size * ilist.num_strips());
+  for (auto &v : x)
+    v = unif(park_miller);
+
+  std::vector<asgard::kronmult::permutes> perms = {asgard::kronmult::permutes(num_dimensions)};
+  std::vector<int> flux_dir = {-1};
+  std::vector<int> terms    = {0};
+
+  asgard::kronmult::block_global_workspace<precision> workspace;
+
+  // reference solution, one direction at a time
+  std::vector<precision> y_ref(x.size(), precision{0});
+  asgard::kronmult::global_cpu(num_dimensions, n, block_size, ilist, dsort, perms,
+                               flux_dir, conn, conn, vals, terms,
+                               asgard::kronmult::sweep_tiles(), x.data(),
+                               y_ref.data(), workspace);
+
+  int64_t const block_bytes = block_size * sizeof(precision);
+  // large cache uses the local buffers, small one mixes in the workspace
+  for (int64_t cache_cells : {int64_t{1} << 20, int64_t{16}, int64_t{4}})
+  {
+    asgard::kronmult::sweep_tiles tiles(ilist, perms, block_bytes,
+                                        2 * cache_cells * block_bytes, 1);
+    if (cache_cells > ilist.num_strips())
+      REQUIRE(not tiles.empty());
+
+    std::vector<precision> y(x.size(), precision{0});
+    asgard::kronmult::global_cpu(num_dimensions, n, block_size, ilist, dsort, perms,
+                                 flux_dir, conn, conn, vals, terms, tiles,
+                                 x.data(), y.data(), workspace);
+
+    test_almost_equal(y, y_ref);
+  }
+}
+
+TEMPLATE_TEST_CASE("testing block global kron, fused sweeps", "[block tiles]", test_precs)
+{
+  int n = GENERATE(1, 2, 3);
+  test_block_tiles<TestType>(2, n, 4);
+  test_block_tiles<TestType>(3, n, 4);
+  test_block_tiles<TestType>(4, n, 3);
+}
+
+TEST_CASE("testing block global kron, thread partitions", "[block split]")
+{
+  int const num_dimensions = 3, level = 5;
+  auto indexes = asgard::permutations::generate_lower_index_set(
+      num_dimensions,
+      [&](std::array<int, asgard::max_num_dimensions> const &index) -> bool {
+        int L = 0;
+        for (int i = 0; i < num_dimensions; i++)
+          L += int_log2(index[i]);
+        return (L <= level);
+      });
+
+  asgard::connect_1d conn(level, asgard::connect_1d::hierarchy::volume);
+
+  asgard::vector2d<int> ilist(num_dimensions, indexes);
+  asgard::dimension_sort dsort(ilist);
+
+  using fill = asgard::kronmult::permutes::matrix_fill;
+  for (int dim = 0; dim < num_dimensions; dim++)
+  {
+    for (auto f : {fill::lower, fill::upper, fill::both})
+    {
+      asgard::kronmult::sweep_plan plan(ilist, dsort, dim, f, conn);
+      for (int num_threads : {1, 3, 8, 1000})
+      {
+        for (bool whole_vecs : {false, true})
+        {
+          // the ranges must be consecutive and cover all rows
+          int next = 0;
+          for (int t = 0; t < num_threads; t++)
+          {
+            auto const [rbegin, rend] = plan.split(t, num_threads, whole_vecs);
+            REQUIRE(rbegin == next);
+            REQUIRE(rbegin <= rend);
+            if (whole_vecs)
+              REQUIRE(std::binary_search(plan.vecs.begin(), plan.vecs.end(), rend));
+            next = rend;
+          }
+          REQUIRE(next == ilist.num_strips());
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("testing block global kron, roofline counts", "[block roofline]")
+{
+  int const num_dimensions = 3, level = 5, n = 2;
+  auto indexes = asgard::permutations::generate_lower_index_set(
+      num_dimensions,
+      [&](std::array<int, asgard::max_num_dimensions> const &index) -> bool {
+        int L = 0;
+        for (int i = 0; i < num_dimensions; i++)
+          L += int_log2(index[i]);
+        return (L <= level);
+      });
+
+  asgard::connect_1d conn(level, asgard::connect_1d::hierarchy::volume);
+
+  asgard::vector2d<int> ilist(num_dimensions, indexes);
+  asgard::dimension_sort dsort(ilist);
+
+  int64_t const block_size = asgard::fm::ipow(n, num_dimensions);
+
+  std::vector<asgard::kronmult::permutes> perms = {asgard::kronmult::permutes(num_dimensions)};
+  std::vector<int> flux_dir = {-1};
+  std::vector<int> terms    = {0};
+
+  // the direct count must match the connections of the sweep plans
+  int64_t num_connect = 0;
+  for (size_t i = 0; i < perms[0].fill.size(); i++)
+    for (int d = 0; d < num_dimensions; d++)
+      num_connect += asgard::kronmult::sweep_plan(ilist, dsort, perms[0].direction[i][d],
+                                                  perms[0].fill[i][d], conn)
+                         .num_connections();
+
+  asgard::kronmult::kron_roofline const roofline =
+      asgard::kronmult::block_global_roofline<asgard::default_precision>(
+          num_dimensions, n, block_size, ilist, dsort, perms, flux_dir, conn, conn,
+          terms, sizeof(asgard::default_precision));
+
+  REQUIRE(roofline.flops == 2 * n * block_size * num_connect);
+  REQUIRE(roofline.bytes > 0);
+  REQUIRE(roofline.intensity() > 0);
+}
+
+template<typename precision>
+void test_block_simd(int num_dimensions, int n, int level)
+{
+  std::minstd_rand park_miller(42);
+  std::uniform_real_distribution<precision> unif(-1.0, 1.0);
+
+  auto indexes = asgard::permutations::generate_lower_index_set(
+      num_dimensions,
+      [&](std::array<int, asgard::max_num_dimensions> const &index) -> bool {
+        int L = 0;
+        for (int i = 0; i < num_dimensions; i++)
+          L += int_log2(index[i]);
+        return (L <= level);
+      });
+
+  asgard::connect_1d conn(level, asgard::connect_1d::hierarchy::volume);
+
+  asgard::vector2d<int> ilist(num_dimensions, indexes);
+  asgard::dimension_sort dsort(ilist);
+
+  int64_t const block_size = asgard::fm::ipow(n, num_dimensions);
+
+  std::vector<std::vector<precision>> vals(num_dimensions);
+  for (auto &v : vals)
+  {
+    v.resize(n * n * conn.num_connections());
+    for (auto &a : v)
+      a = unif(park_miller);
+  }
+
+  std::vector<precision> x(block_size * ilist.num_strips());
+  for (auto &v : x)
+    v = unif(park_miller);
+
+  std::vector<asgard::kronmult::permutes> perms = {asgard::kronmult::permutes(num_dimensions)};
+  std::vector<int> flux_dir = {-1};
+  std::vector<int> terms    = {0};
+
+  asgard::kronmult::block_global_workspace<precision> workspace;
+
+  auto const active = asgard::kronmult::get_simd_isa();
+
+  asgard::kronmult::set_simd_isa(asgard::kronmult::simd_isa::scalar);
+  std::vector<precision> y_ref(x.size(), precision{0});
+  asgard::kronmult::global_cpu(num_dimensions, n, block_size, ilist, dsort, perms,
+                               flux_dir, conn, conn, vals, terms,
+                               asgard::kronmult::sweep_tiles(), x.data(),
+                               y_ref.data(), workspace);
+
+  for (auto isa : {asgard::kronmult::simd_isa::avx2, asgard::kronmult::simd_isa::avx512})
+  {
+    if (static_cast<int>(isa) > static_cast<int>(asgard::kronmult::detected_simd_isa()))
+    {
+      REQUIRE_THROWS_AS(asgard::kronmult::set_simd_isa(isa), std::runtime_error);
+      continue;
+    }
+    asgard::kronmult::set_simd_isa(isa);
+
+    std::vector<precision> y(x.size(), precision{0});
+    asgard::kronmult::global_cpu(num_dimensions, n, block_size, ilist, dsort, perms,
+                                 flux_dir, conn, conn, vals, terms,
+                                 asgard::kronmult::sweep_tiles(), x.data(),
+                                 y.data(), workspace);
+
+    test_almost_equal(y, y_ref);
+  }
+
+  asgard::kronmult::set_simd_isa(active);
+}
+
+TEMPLATE_TEST_CASE("testing block global kron, simd kernels", "[block simd]", test_precs)
+{
+  int n = GENERATE(2, 3, 4);
+  test_block_simd<TestType>(2, n, 4);
+  test_block_simd<TestType>(3, n, 3);
+  test_block_simd<TestType>(4, n, 2);
+}
+
+template<typename precision>
+void test_block_multirhs(int num_dimensions, int n, int level, int num_rhs)
+{
+  std::minstd_rand park_miller(42);
+  std::uniform_real_distribution<precision> unif(-1.0, 1.0);
+
+  auto indexes = asgard::permutations::generate_lower_index_set(
+      num_dimensions,
+      [&](std::array<int, asgard::max_num_dimensions> const &index) -> bool {
+        int L = 0;
+        for (int i = 0; i < num_dimensions; i++)
+          L += int_log2(index[i]);
+        return (L <= level);
+      });
+
+  asgard::connect_1d conn(level, asgard::connect_1d::hierarchy::volume);
+
+  asgard::vector2d<int> ilist(num_dimensions, indexes);
+  asgard::dimension_sort dsort(ilist);
+
+  int64_t const block_size  = asgard::fm::ipow(n, num_dimensions);
+  int64_t const num_entries = block_size * ilist.num_strips();
+
+  std::vector<std::vector<precision>> vals(num_dimensions);
+  for (auto &v : vals)
+  {
+    v.resize(n * n * conn.num_connections());
+    for (auto &a : v)
+      a = unif(park_miller);
+  }
+
+  std::vector<precision> x(num_entries * num_rhs);
+  for (auto &v : x)
+    v = unif(park_miller);
+
+  std::vector<asgard::kronmult::permutes> perms = {asgard::kronmult::permutes(num_dimensions)};
+  std::vector<int> flux_dir = {-1};
+  std::vector<int> terms    = {0};
+
+  asgard::kronmult::block_global_workspace<precision> workspace;
+
+  // interleaved product of all vectors at once
+  std::vector<precision> y(x.size(), precision{0});
+  asgard::kronmult::global_cpu(num_dimensions, n, block_size, ilist, dsort, perms,
+                               flux_dir, conn, conn, vals, terms, num_rhs,
+                               x.data(), y.data(), workspace);
+
+  // reference solution, one vector at a time
+  std::vector<precision> xv(num_entries), yv(num_entries), y_ref(x.size());
+  for (int v = 0; v < num_rhs; v++)
+  {
+    for (int64_t i = 0; i < num_entries; i++)
+      xv[i] = x[i * num_rhs + v];
+    std::fill(yv.begin(), yv.end(), precision{0});
+    asgard::kronmult::global_cpu(num_dimensions, n, block_size, ilist, dsort, perms,
+                                 flux_dir, conn, conn, vals, terms,
+                                 asgard::kronmult::sweep_tiles(), xv.data(),
+                                 yv.data(), workspace);
+    for (int64_t i = 0; i < num_entries; i++)
+      y_ref[i * num_rhs + v] = yv[i];
+  }
+
+  test_almost_equal(y, y_ref);
+}
+
+TEMPLATE_TEST_CASE("testing block global kron, multiple vectors", "[block multirhs]", test_precs)
+{
+  int n = GENERATE(1, 2, 3);
+  int r = GENERATE(2, 3, 4);
+  test_block_multirhs<TestType>(2, n, 4, r);
+  test_block_multirhs<TestType>(3, n, 3, r);
+}
+
+#ifdef ASGARD_ENABLE_DOUBLE
+void test_block_single(int num_dimensions, int n, int level)
+{
+  std::minstd_rand park_miller(42);
+  std::uniform_real_distribution<double> unif(-1.0, 1.0);
+
+  auto indexes = asgard::permutations::generate_lower_index_set(
+      num_dimensions,
+      [&](std::array<int, asgard::max_num_dimensions> const &index) -> bool {
+        int L = 0;
+        for (int i = 0; i < num_dimensions; i++)
+          L += int_log2(index[i]);
+        return (L <= level);
+      });
+
+  asgard::connect_1d conn(level, asgard::connect_1d::hierarchy::volume);
+
+  asgard::vector2d<int> ilist(num_dimensions, indexes);
+  asgard::dimension_sort dsort(ilist);
+
+  int64_t const block_size = asgard::fm::ipow(n, num_dimensions);
+
+  // the single precision values and their exact double counterparts
+  std::vector<std::vector<double>> vals(num_dimensions), rvals(num_dimensions);
+  std::vector<std::vector<float>> svals(num_dimensions);
+  for (int d = 0; d < num_dimensions; d++)
+  {
+    vals[d].resize(n * n * conn.num_connections());
+    for (auto &a : vals[d])
+      a = unif(park_miller);
+    svals[d] = std::vector<float>(vals[d].begin(), vals[d].end());
+    rvals[d] = std::vector<double>(svals[d].begin(), svals[d].end());
+  }
+
+  std::vector<double> x(block_size * ilist.num_strips());
+  for (auto &v : x)
+    v = unif(park_miller);
+
+  std::vector<asgard::kronmult::permutes> perms = {asgard::kronmult::permutes(num_dimensions)};
+  std::vector<int> flux_dir = {-1};
+  std::vector<int> terms    = {0};
+
+  asgard::kronmult::block_global_workspace<double> workspace;
+
+  std::vector<double> y_ref(x.size(), 0.0), y_round(x.size(), 0.0);
+  asgard::kronmult::global_cpu(num_dimensions, n, block_size, ilist, dsort, perms,
+                               flux_dir, conn, conn, vals, terms,
+                               asgard::kronmult::sweep_tiles(), x.data(),
+                               y_ref.data(), workspace);
+  asgard::kronmult::global_cpu(num_dimensions, n, block_size, ilist, dsort, perms,
+                               flux_dir, conn, conn, rvals, terms,
+                               asgard::kronmult::sweep_tiles(), x.data(),
+                               y_round.data(), workspace);
+
+  int64_t const block_bytes = block_size * sizeof(double);
+  // check both the direction-by-direction and the fused sweeps
+  for (auto const &tiles : {asgard::kronmult::sweep_tiles(),
+                            asgard::kronmult::sweep_tiles(ilist, perms, block_bytes)})
+  {
+    std::vector<double> y(x.size(), 0.0);
+    asgard::kronmult::global_cpu(num_dimensions, n, block_size, ilist, dsort, perms,
+                                 flux_dir, conn, conn, svals, terms, tiles,
+                                 x.data(), y.data(), workspace);
+
+    // the products are accumulated in double precision
+    test_almost_equal(y, y_round);
+    // only the rounding of the coefficients is lost
+    rmse_comparison<double>(asgard::fk::vector<double>(y),
+                            asgard::fk::vector<double>(y_ref),
+                            get_tolerance<float>(10));
+  }
+}
+
+TEST_CASE("testing block global kron, single precision coefficients", "[block single]")
+{
+  int n = GENERATE(1, 2, 3);
+  test_block_single(2, n, 4);
+  test_block_single(3, n, 3);
+  test_block_single(4, n, 2);
+}
+#endif
+#endif
+
 #ifdef ASGARD_USE_CUDA
 TEMPLATE_TEST_CASE("testing cusparse functionality", "[cusparse]", test_precs)
 {
@@ -0,0 +1,138 @@
+
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <string>
+
+#include "./device/asgard_kronmult.hpp"
+#include "lib_dispatch.hpp"
+#include "permutations.hpp"
+
+using precision = asgard::default_precision;
+
+// number of levels in the multi-index, i.e., level 0 is index 0 and level 1 is index 1
+int index_level(int i)
+{
+  int l = 0;
+  while (i > 0)
+  {
+    i /= 2;
+    l += 1;
+  }
+  return l;
+}
+
+template<typename callable>
+double time_ms(int num_tests, callable call)
+{
+  call(); // dry run
+  auto time_start = std::chrono::system_clock::now();
+  for (int i = 0; i < num_tests; i++)
+    call();
+  auto time_end = std::chrono::system_clock::now();
+  return std::chrono::duration<double, std::milli>(time_end - time_start).count() / num_tests;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 4)
+  {
+    std::cout
+#ifdef ASGARD_ENABLE_DOUBLE
+        << "\n build for double precision"
+#else
+        << "\n build for single precision"
+#endif
+        << " using the dense CPU kronmult with n = 1\n"
+        << "\n Usage:\n"
+        << "./asgard_scalar_kronmult_benchmark <dimensions> <level> <num_terms> [num_rhs] [num_tests]\n\n"
+        << " e.g., ./asgard_scalar_kronmult_benchmark 2 8 3\n"
+        << "       ./asgard_scalar_kronmult_benchmark 3 7 4 8 20\n"
+        << "\n compares the kernel that forms the Kronecker products on the fly"
+        << "\n against the combined matrix used with gemv and gemm (num_rhs vectors)\n\n";
+    return 1;
+  }
+
+  int const num_dimensions = std::stoi(argv[1]);
+  int const level          = std::stoi(argv[2]);
+  int const num_terms      = std::stoi(argv[3]);
+  int const num_rhs        = (argc > 4) ? std::stoi(argv[4]) : 8;
+  int const num_tests      = (argc > 5) ? std::stoi(argv[5]) : 10;
+
+  std::vector<int> const elem = asgard::permutations::generate_lower_index_set(
+      num_dimensions,
+      [&](std::array<int, asgard::max_num_dimensions> const &index) -> bool {
+        int L = 0;
+        for (int i = 0; i < num_dimensions; i++)
+          L += index_level(index[i]);
+        return (L <= level);
+      });
+
+  int const num_rows      = static_cast<int>(elem.size()) / num_dimensions;
+  int const num_1d_blocks = asgard::fm::two_raised_to(level);
+
+  std::cout << "benchmarking:\n"
+            << "dimensions: " << num_dimensions << "  level: " << level
+            << "  terms: " << num_terms << "  cells: " << num_rows << "\n";
+
+  std::minstd_rand park_miller(42);
+  std::uniform_real_distribution<precision> unif(-1.0, 1.0);
+
+  std::vector<std::vector<precision>> terms(num_terms);
+  std::vector<precision const *> pterms(num_terms);
+  for (int t = 0; t < num_terms; t++)
+  {
+    terms[t].resize(num_dimensions * num_1d_blocks * num_1d_blocks);
+    for (auto &v : terms[t])
+      v = unif(park_miller);
+    pterms[t] = terms[t].data();
+  }
+
+  std::vector<precision> x(int64_t{num_rows} * num_rhs), y(num_rows), z(num_rows);
+  for (auto &v : x)
+    v = unif(park_miller);
+
+  double const products = double(num_rows) * double(num_rows);
+  std::cout << std::fixed << std::setprecision(4);
+
+  double const kron_time = time_ms(num_tests, [&]() -> void {
+    asgard::kronmult::cpu_dense(num_dimensions, 1, num_rows, num_rows, num_terms,
+                                elem.data(), 0, 0, pterms.data(), num_1d_blocks,
+                                precision{1}, x.data(), precision{0}, y.data());
+  });
+  std::cout << "on-the-fly kernel:  " << kron_time << "ms  Gflops / second: "
+            << 1.E-6 * products * (num_dimensions + 1) * num_terms / kron_time << "\n";
+
+  std::vector<precision> M(int64_t{num_rows} * num_rows);
+  double const combine_time = time_ms(1, [&]() -> void {
+    asgard::kronmult::cpu_n0_combine(num_dimensions, num_rows, num_rows, num_terms,
+                                     elem.data(), 0, 0, pterms.data(),
+                                     num_1d_blocks, M.data());
+  });
+  std::cout << "combine products:   " << combine_time << "ms  (once per update)\n";
+
+  double const gemv_time = time_ms(num_tests, [&]() -> void {
+    asgard::lib_dispatch::gemv('n', num_rows, num_rows, precision{1}, M.data(),
+                               num_rows, x.data(), 1, precision{0}, z.data(), 1);
+  });
+  std::cout << "combined gemv:      " << gemv_time << "ms  Gflops / second: "
+            << 2.E-6 * products / gemv_time
+            << "  speedup: " << kron_time / gemv_time << "\n";
+
+  precision err = 0;
+  for (int i = 0; i < num_rows; i++)
+    err = std::max(err, std::abs(y[i] - z[i]));
+  std::cout << "max difference:     " << std::scientific << err << std::fixed << "\n";
+
+  std::vector<precision> Y(int64_t{num_rows} * num_rhs);
+  double const gemm_time = time_ms(num_tests, [&]() -> void {
+    asgard::lib_dispatch::gemm('n', 'n', num_rows, num_rhs, num_rows, precision{1},
+                               M.data(), num_rows, x.data(), num_rows, precision{0},
+                               Y.data(), num_rows);
+  });
+  std::cout << "combined gemm (" << num_rhs << "): " << gemm_time
+            << "ms  Gflops / second: " << 2.E-6 * products * num_rhs / gemm_time
+            << "  per vector speedup: " << num_rhs * kron_time / gemm_time << "\n";
+
+  return 0;
+}
@@ -1,16 +1,22 @@
 
+#include <atomic>
+#include <cstring>
+
 #include "asgard_kronmult.hpp"
 
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 
+// explicit simd kernels selected at runtime, requires gcc/clang on x86
+#if (defined(__GNUC__) or defined(__clang__)) and (defined(__x86_64__) or defined(__i386__))
+#define ASGARD_KRON_SIMD_DISPATCH
+#endif
+
 namespace asgard::kronmult
 {
-#ifdef KRON_MODE_GLOBAL_BLOCK
-
-template<typename precision, int num_dimensions, int dim, int n>
-void gbkron_mult_add(precision const A[], precision const x[], precision y[])
+template<typename precision, int num_dimensions, int dim, int n, typename cprecision>
+void gbkron_mult_add(cprecision const A[], precision const x[], precision y[])
 {
   if constexpr (n == 1) // dimension does not matter here
   {
@@ -265,185 +271,590 @@ void gbkron_mult_add(precision const A[], precision const x[], precision y[])
   }
 }
 
-int64_t number_of_blocks_;
+//! \brief Same as ipow() but also allows for power zero.
+template<int n, int power>
+constexpr int ipow_or_one()
+{
+  if constexpr (power == 0)
+    return 1;
+  else
+    return ipow<n, power>();
+}
+
+/*!
+ * \brief Multi-vector variant of gbkron_mult_add()
+ *
+ * Works with num_rhs vectors stored in interleaved format,
+ * i.e., entry i of vector v is at i * num_rhs + v.
+ * The vectors act as an extra fastest index of the block, so the entries
+ * of A are loaded once for all vectors and the inner loop is contiguous
+ * even for the last dimension.
+ */
+template<typename precision, int num_dimensions, int dim, int n, typename cprecision>
+inline __attribute__((always_inline)) void
+gbkron_mult_add(int num_rhs, cprecision const A[], precision const x[], precision y[])
+{
+  constexpr int inner = ipow_or_one<n, num_dimensions - dim - 1>();
+  constexpr int outer = ipow_or_one<n, dim>();
+
+  int const stride = inner * num_rhs;
+
+  for (int o = 0; o < outer; o++)
+  {
+    precision const *xo = x + o * n * stride;
+    precision *yo       = y + o * n * stride;
+    for (int s = 0; s < n; s++)
+    {
+      precision *ys = yo + s * stride;
+      for (int j = 0; j < n; j++)
+      {
+        precision const a   = A[j * n + s];
+        precision const *xj = xo + j * stride;
+        ASGARD_PRAGMA_OMP_SIMD()
+        for (int i = 0; i < stride; i++)
+          ys[i] += a * xj[i];
+      }
+    }
+  }
+}
+
+#ifdef ASGARD_KRON_SIMD_DISPATCH
+/*!
+ * \brief Explicitly vectorized variant of gbkron_mult_add()
+ *
+ * The block is viewed as y[outer][n][inner], where the 1d matrix acts on
+ * the middle index and inner = n^(num_dimensions - dim - 1).
+ * The inner index is contiguous in memory and processed in packs of
+ * vbytes, with the entry of A broadcast across the pack.
+ * If the inner index is too short to fill a pack, i.e., when working with
+ * the last dimensions, this falls back to the generic gbkron_mult_add().
+ *
+ * Must be inlined into a function compiled for the corresponding instruction set.
+ */
+template<typename precision, int num_dimensions, int dim, int n, int vbytes, typename cprecision>
+inline __attribute__((always_inline)) void
+gbkron_mult_add_simd(cprecision const A[], precision const x[], precision y[])
+{
+  constexpr int vlen  = vbytes / static_cast<int>(sizeof(precision));
+  constexpr int inner = ipow_or_one<n, num_dimensions - dim - 1>();
+  constexpr int outer = ipow_or_one<n, dim>();
+
+  if constexpr (n == 1 or inner < vlen)
+  {
+    gbkron_mult_add<precision, num_dimensions, dim, n>(A, x, y);
+  }
+  else
+  {
+    typedef precision pack __attribute__((vector_size(vbytes)));
+
+    constexpr int tail = (inner / vlen) * vlen;
+
+    for (int o = 0; o < outer; o++)
+    {
+      precision const *xo = x + o * n * inner;
+      precision *yo       = y + o * n * inner;
+      for (int s = 0; s < n; s++)
+      {
+        precision *ys = yo + s * inner;
+        for (int i = 0; i < tail; i += vlen)
+        {
+          pack acc, xv;
+          std::memcpy(&acc, ys + i, vbytes);
+          for (int j = 0; j < n; j++)
+          {
+            std::memcpy(&xv, xo + j * inner + i, vbytes);
+            acc += static_cast<precision>(A[j * n + s]) * xv;
+          }
+          std::memcpy(ys + i, &acc, vbytes);
+        }
+        for (int i = tail; i < inner; i++)
+          for (int j = 0; j < n; j++)
+            ys[i] += A[j * n + s] * xo[j * inner + i];
+      }
+    }
+  }
+}
+#endif
 
-template<typename precision, permutes::matrix_fill fill, int num_dimensions, int dim, int n>
-void global_cpu(vector2d<int> const &ilist,
-                dimension_sort const &dsort, connect_1d const &conn,
-                precision const vals[], precision const x[], precision y[],
-                std::vector<std::vector<int64_t>> &row_wspace)
+/*!
+ * \brief Multiplies all the connected columns for one row
+ *
+ * The columns are the cells cols[0], cols[1], ..., cols[num_cols - 1]
+ * and the 1d matrix of column c starts at vals + n * n * coeffs[c].
+ * The block of cell cols[c] is at offset xmap[cols[c]] of x,
+ * or at offset cols[c] if xmap is null, counting in number of blocks.
+ * The y is incremented with the products of the 1d matrices and the x blocks.
+ *
+ * The vbytes indicates the width of the simd pack, zero means generic code.
+ * If num_rhs is more than one, x and y hold interleaved vectors.
+ */
+template<typename precision, int num_dimensions, int dim, int n, int vbytes, typename cprecision>
+inline __attribute__((always_inline)) void
+gbkron_row_add(int num_cols, int const cols[], int const coeffs[], int const xmap[],
+               cprecision const vals[], precision const x[], precision y[], int num_rhs)
 {
   constexpr int n2 = n * n;
+  // with multiple vectors, each block holds the interleaved entries of all vectors
+  int64_t const block_size = ipow<n, num_dimensions>() * num_rhs;
+  if (num_rhs > 1)
+  {
+    for (int c = 0; c < num_cols; c++)
+    {
+      int64_t const xj = ((xmap == nullptr) ? cols[c] : xmap[cols[c]]) * block_size;
+      gbkron_mult_add<precision, num_dimensions, dim, n>(num_rhs, vals + n2 * coeffs[c], x + xj, y);
+    }
+    return;
+  }
+  for (int c = 0; c < num_cols; c++)
+  {
+    int64_t const xj = ((xmap == nullptr) ? cols[c] : xmap[cols[c]]) * block_size;
+#ifdef ASGARD_KRON_SIMD_DISPATCH
+    if constexpr (vbytes > 0)
+      gbkron_mult_add_simd<precision, num_dimensions, dim, n, vbytes>(vals + n2 * coeffs[c], x + xj, y);
+    else
+#endif
+      gbkron_mult_add<precision, num_dimensions, dim, n>(vals + n2 * coeffs[c], x + xj, y);
+  }
+}
 
-  constexpr int64_t block_size = ipow<n, num_dimensions>();
+#ifdef ASGARD_KRON_SIMD_DISPATCH
+template<typename precision, int num_dimensions, int dim, int n, typename cprecision>
+__attribute__((target("avx2,fma"))) void
+gbkron_row_add_avx2(int num_cols, int const cols[], int const coeffs[], int const xmap[],
+                    cprecision const vals[], precision const x[], precision y[], int num_rhs)
+{
+  gbkron_row_add<precision, num_dimensions, dim, n, 32>(num_cols, cols, coeffs, xmap, vals, x, y, num_rhs);
+}
 
-  int const num_vecs = dsort.num_vecs(dim);
+template<typename precision, int num_dimensions, int dim, int n, typename cprecision>
+__attribute__((target("avx512f"))) void
+gbkron_row_add_avx512(int num_cols, int const cols[], int const coeffs[], int const xmap[],
+                      cprecision const vals[], precision const x[], precision y[], int num_rhs)
+{
+  gbkron_row_add<precision, num_dimensions, dim, n, 64>(num_cols, cols, coeffs, xmap, vals, x, y, num_rhs);
+}
+#endif
 
-#ifdef _OPENMP
-  int const max_threads = omp_get_max_threads();
+//! \brief Calls the row kernel compiled for the given instruction set.
+template<typename precision, int num_dimensions, int dim, int n, typename cprecision>
+void gbkron_row_add(simd_isa isa, sweep_plan const &plan, int row, int const xmap[],
+                    cprecision const vals[], precision const x[], precision y[],
+                    int num_rhs = 1)
+{
+  int64_t const cbegin = plan.pntr[row];
+  int const num_cols   = static_cast<int>(plan.pntr[row + 1] - cbegin);
+  int const *cols      = plan.cols.data() + cbegin;
+  int const *coeffs    = plan.coeffs.data() + cbegin;
+#ifdef ASGARD_KRON_SIMD_DISPATCH
+  switch (isa)
+  {
+  case simd_isa::avx512:
+    gbkron_row_add_avx512<precision, num_dimensions, dim, n>(num_cols, cols, coeffs, xmap, vals, x, y, num_rhs);
+    break;
+  case simd_isa::avx2:
+    gbkron_row_add_avx2<precision, num_dimensions, dim, n>(num_cols, cols, coeffs, xmap, vals, x, y, num_rhs);
+    break;
+  default: // case simd_isa::scalar:
+    gbkron_row_add<precision, num_dimensions, dim, n, 0>(num_cols, cols, coeffs, xmap, vals, x, y, num_rhs);
+    break;
+  }
 #else
-  int const max_threads = 1;
+  ignore(isa);
+  gbkron_row_add<precision, num_dimensions, dim, n, 0>(num_cols, cols, coeffs, xmap, vals, x, y, num_rhs);
+#endif
+}
+
+simd_isa detected_simd_isa()
+{
+  static simd_isa const isa = []() -> simd_isa {
+#ifdef ASGARD_KRON_SIMD_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+      return simd_isa::avx512;
+    if (__builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma"))
+      return simd_isa::avx2;
 #endif
+    return simd_isa::scalar;
+  }();
+  return isa;
+}
 
-  if (static_cast<int>(row_wspace.size()) < max_threads)
-    row_wspace.resize(max_threads);
+// the instruction set used by the kernels, -1 means not set yet
+static std::atomic<int> active_simd_isa_ = -1;
 
-  int threadid = 0;
-#pragma omp parallel
+simd_isa get_simd_isa()
+{
+  int isa = active_simd_isa_.load();
+  if (isa == -1)
   {
-    int tid;
-#pragma omp critical
-    tid = threadid++;
+    isa = static_cast<int>(detected_simd_isa());
+    active_simd_isa_.store(isa);
+  }
+  return static_cast<simd_isa>(isa);
+}
 
-    // xidx holds indexes for the entries of the current
-    // sparse row that are present in the current ilist
-    std::vector<int64_t> &xidx = row_wspace[tid];
-    if (static_cast<int>(xidx.size()) < conn.num_rows())
-      xidx.resize(conn.num_rows(), -1);
+void set_simd_isa(simd_isa isa)
+{
+  if (static_cast<int>(isa) > static_cast<int>(detected_simd_isa()))
+    throw std::runtime_error("(kronmult) the requested instruction set is not supported by the cpu");
+  active_simd_isa_.store(static_cast<int>(isa));
+}
 
-#pragma omp for schedule(dynamic)
-    for (int vec_id = 0; vec_id < num_vecs; vec_id++)
-    {
-      int const vec_begin = dsort.vec_begin(dim, vec_id);
-      int const vec_end   = dsort.vec_end(dim, vec_id);
-      // map the indexes of present entries
-      for (int j = vec_begin; j < vec_end; j++)
-        xidx[dsort(ilist, dim, j)] = dsort.map(dim, j) * block_size;
+sweep_plan::sweep_plan(vector2d<int> const &ilist, dimension_sort const &dsort, int d,
+                       permutes::matrix_fill f, connect_1d const &c)
+    : dim(d), fill(f), conn(&c), cells(ilist[0]), num_cells(ilist.num_strips())
+{
+  rows.resize(num_cells);
+  index.resize(num_cells);
+  pntr.reserve(num_cells + 1);
+  pntr.push_back(0);
 
-      // matrix-vector product using xidx as a row
-      for (int rj = vec_begin; rj < vec_end; rj++)
-      {
-        // row in the 1d pattern
-        int const row = dsort(ilist, dim, rj);
+  // xidx holds the cells for the entries of the current
+  // sparse row that are present in the current ilist
+  std::vector<int> xidx(conn->num_rows(), -1);
 
-        precision *const local_y = y + xidx[row];
+  int const num_vecs = dsort.num_vecs(dim);
+  vecs.resize(num_vecs + 1);
+  for (int vec_id = 0; vec_id < num_vecs; vec_id++)
+  {
+    int const vec_begin = dsort.vec_begin(dim, vec_id);
+    int const vec_end   = dsort.vec_end(dim, vec_id);
+    vecs[vec_id]        = vec_begin;
+    // map the indexes of present entries
+    for (int j = vec_begin; j < vec_end; j++)
+      xidx[dsort(ilist, dim, j)] = dsort.map(dim, j);
+
+    for (int rj = vec_begin; rj < vec_end; rj++)
+    {
+      // row in the 1d pattern
+      int const row = dsort(ilist, dim, rj);
 
-        // columns for the 1d pattern
-        int col_begin = (fill == permutes::matrix_fill::upper) ? conn.row_diag(row) : conn.row_begin(row);
-        int col_end   = (fill == permutes::matrix_fill::lower) ? conn.row_diag(row) : conn.row_end(row);
+      rows[rj]        = xidx[row];
+      index[rows[rj]] = rj;
 
-        if constexpr (n != -1)
-          for (int j = 0; j < block_size; j++)
-            local_y[j] = precision{0};
+      // columns for the 1d pattern
+      int col_begin = (fill == permutes::matrix_fill::upper) ? conn->row_diag(row) : conn->row_begin(row);
+      int col_end   = (fill == permutes::matrix_fill::lower) ? conn->row_diag(row) : conn->row_end(row);
 
-        for (int c = col_begin; c < col_end; c++)
+      for (int j = col_begin; j < col_end; j++)
+      {
+        if (xidx[(*conn)[j]] != -1)
         {
-          int64_t const xj = xidx[conn[c]];
-          if (xj != -1)
-          {
-            if constexpr (n == -1)
-#pragma omp atomic
-              number_of_blocks_ += 1;
-            else
-              gbkron_mult_add<precision, num_dimensions, dim, n>(vals + n2 * c, x + xj, local_y);
-          }
+          cols.push_back(xidx[(*conn)[j]]);
+          coeffs.push_back(j);
         }
       }
-
-      // restore the entries
-      for (int j = vec_begin; j < vec_end; j++)
-        xidx[dsort(ilist, dim, j)] = -1;
+      pntr.push_back(static_cast<int64_t>(cols.size()));
     }
+
+    // restore the entries
+    for (int j = vec_begin; j < vec_end; j++)
+      xidx[dsort(ilist, dim, j)] = -1;
   }
+  vecs.back() = static_cast<int>(num_cells);
 }
 
-template<typename precision, int num_dimensions, int dim, int n>
-void globalsv_cpu(vector2d<int> const &ilist, dimension_sort const &dsort,
-                  connect_1d const &conn, precision const vals[],
-                  precision y[], std::vector<std::vector<int64_t>> &row_wspace)
+std::array<int, 2> sweep_plan::split(int tid, int num_threads, bool whole_vecs) const
 {
-  constexpr int n2 = n * n;
+  // the total cost of the rows before row r is r + pntr[r]
+  int64_t const total = num_cells + pntr.back();
+
+  // finds the first row with cost not less than the share of the threads before t
+  auto row_bound = [&](int t) -> int {
+    if (t == 0)
+      return 0;
+    if (t == num_threads)
+      return static_cast<int>(num_cells);
+    int64_t const target = (total * t) / num_threads;
+    if (whole_vecs)
+    {
+      auto it = std::lower_bound(vecs.begin(), vecs.end(), target,
+                                 [&](int r, int64_t v) -> bool { return r + pntr[r] < v; });
+      return *it;
+    }
+    int lo = 0, hi = static_cast<int>(num_cells);
+    while (lo < hi)
+    {
+      int const mid = (lo + hi) / 2;
+      if (mid + pntr[mid] < target)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return lo;
+  };
 
-  constexpr int64_t block_size = ipow<n, num_dimensions>();
+  return {row_bound(tid), row_bound(tid + 1)};
+}
 
-  int const num_vecs = dsort.num_vecs(dim);
+//! \brief Returns the cached plan for the parameters, builds a new plan if missing.
+sweep_plan const &get_sweep_plan(std::deque<sweep_plan> &plans, vector2d<int> const &ilist,
+                                 dimension_sort const &dsort, int dim,
+                                 permutes::matrix_fill fill, connect_1d const &conn)
+{
+  for (auto const &plan : plans)
+    if (plan.matches(ilist, dim, fill, conn))
+      return plan;
+  plans.emplace_back(ilist, dsort, dim, fill, conn);
+  return plans.back();
+}
 
+/*!
+ * \brief Returns the range of plan rows assigned to the calling thread.
+ *
+ * Called from inside a parallel region the rows are split between the threads
+ * of the team, outside of a parallel region all rows go to the single thread.
+ */
+std::array<int, 2> team_rows(sweep_plan const &plan, bool whole_vecs)
+{
 #ifdef _OPENMP
-  int const max_threads = omp_get_max_threads();
+  return plan.split(omp_get_thread_num(), omp_get_num_threads(), whole_vecs);
 #else
-  int const max_threads = 1;
+  return plan.split(0, 1, whole_vecs);
 #endif
+}
 
-  if (static_cast<int>(row_wspace.size()) < max_threads)
-    row_wspace.resize(max_threads);
+/*!
+ * \brief Sweep in direction dim, called by all threads of the team.
+ *
+ * There is no barrier at the end, the caller must synchronize the team
+ * before the result is used.
+ */
+template<typename precision, int num_dimensions, int dim, int n, typename cprecision>
+void global_cpu(sweep_plan const &plan, cprecision const vals[],
+                precision const x[], precision y[], int num_rhs)
+{
+  // with multiple vectors, each block holds the interleaved entries of all vectors
+  int64_t const block_size = ipow<n, num_dimensions>() * num_rhs;
 
-  int threadid = 0;
-#pragma omp parallel
+  simd_isa const isa = get_simd_isa();
+
+  auto const [row_begin, row_end] = team_rows(plan, false);
+  for (int rj = row_begin; rj < row_end; rj++)
   {
-    int tid;
-#pragma omp critical
-    tid = threadid++;
+    precision *const local_y = y + plan.rows[rj] * block_size;
 
-    // xidx holds indexes for the entries of the current
-    // sparse row that are present in the current ilist
-    std::vector<int64_t> &xidx = row_wspace[tid];
-    if (static_cast<int>(xidx.size()) < conn.num_rows())
-      xidx.resize(conn.num_rows(), -1);
+    for (int64_t j = 0; j < block_size; j++)
+      local_y[j] = precision{0};
 
-#pragma omp for schedule(dynamic)
-    for (int vec_id = 0; vec_id < num_vecs; vec_id++)
-    {
-      int const vec_begin = dsort.vec_begin(dim, vec_id);
-      int const vec_end   = dsort.vec_end(dim, vec_id);
-      // map the indexes of present entries
-      for (int j = vec_begin; j < vec_end; j++)
-        xidx[dsort(ilist, dim, j)] = dsort.map(dim, j) * block_size;
+    gbkron_row_add<precision, num_dimensions, dim, n>(
+        isa, plan, rj, nullptr, vals, x, local_y, num_rhs);
+  }
+}
 
-      // matrix-vector product using xidx as a row
-      for (int rj = vec_begin; rj < vec_end; rj++)
-      {
-        // row in the 1d pattern
-        int const row = dsort(ilist, dim, rj);
+//! \brief Solve in direction dim, called by all threads of the team, no barrier at the end.
+template<typename precision, int num_dimensions, int dim, int n>
+void globalsv_cpu(sweep_plan const &plan, precision const vals[], precision y[])
+{
+  constexpr int64_t block_size = ipow<n, num_dimensions>();
+
+  simd_isa const isa = get_simd_isa();
+
+  // the rows of each vector are processed in order by the same thread,
+  // since each row uses the already computed preceding rows
+  auto const [row_begin, row_end] = team_rows(plan, true);
+  for (int rj = row_begin; rj < row_end; rj++)
+    gbkron_row_add<precision, num_dimensions, dim, n>(
+        isa, plan, rj, nullptr, vals, y, y + plan.rows[rj] * block_size);
+}
+
+/*!
+ * \brief Sweep in direction dim over the cells of a single tile.
+ *
+ * The x and y can be either the global vectors, in which case a cell with
+ * index c is stored at offset c * block_size, or the tile-local buffers,
+ * where the cell is stored at tset.local[c] * block_size.
+ */
+template<typename precision, int num_dimensions, int dim, int n, typename cprecision>
+void tile_sweep_cpu(sweep_tiles::tile_set const &tset, int tile,
+                    sweep_plan const &plan, cprecision const vals[],
+                    precision const x[], bool x_local, precision y[], bool y_local)
+{
+  constexpr int64_t block_size = ipow<n, num_dimensions>();
+
+  simd_isa const isa = get_simd_isa();
+
+  std::vector<int> const &lcells = tset.lcells[dim];
+  std::vector<int> const &lpntr  = tset.lpntr[dim];
+  std::vector<int> const &tlines = tset.tlines[dim];
+  int const *local               = tset.local.data();
+
+  // the sweep never leaves the tile, so the cells of the tile can go in any order
+  int const cells_begin = lpntr[tlines[tile]];
+  int const cells_end   = lpntr[tlines[tile + 1]];
+  for (int j = cells_begin; j < cells_end; j++)
+  {
+    int const c = lcells[j];
+
+    precision *const local_y = y + ((y_local) ? local[c] : c) * block_size;
+
+    for (int k = 0; k < block_size; k++)
+      local_y[k] = precision{0};
+
+    gbkron_row_add<precision, num_dimensions, dim, n>(
+        isa, plan, plan.index[c], (x_local) ? local : nullptr, vals, x, local_y);
+  }
+}
+
+//! \brief Converts the runtime direction into a template parameter.
+template<typename precision, int num_dimensions, int n, int dim = 0, typename cprecision>
+void tile_sweep_cpu(int d, sweep_tiles::tile_set const &tset, int tile,
+                    sweep_plan const &plan, cprecision const vals[],
+                    precision const x[], bool x_local, precision y[], bool y_local)
+{
+  if constexpr (dim < num_dimensions)
+  {
+    if (d != dim)
+      tile_sweep_cpu<precision, num_dimensions, n, dim + 1>(
+          d, tset, tile, plan, vals, x, x_local, y, y_local);
+    else
+      tile_sweep_cpu<precision, num_dimensions, dim, n>(
+          tset, tile, plan, vals, x, x_local, y, y_local);
+  }
+}
+
+/*!
+ * \brief Applies the first num_fused directions of a permutation tile-by-tile
+ *
+ * Reads from x and writes the result in w1, the intermediate results of tiles
+ * that fit in the cache budget are kept in thread-local buffers, the larger
+ * tiles use w1 and w2 for the intermediate steps.
+ * The directions, sweep plans and values for each stage are given in the arrays.
+ * Called by all threads of the team, the tiles are distributed dynamically
+ * and the team is synchronized at the end.
+ * The tile_wspace must have an entry for each thread of the team.
+ */
+template<typename precision, int num_dimensions, int n, typename cprecision>
+void fused_cpu(sweep_tiles::tile_set const &tset, int num_fused, int const dirs[],
+               sweep_plan const *const plans[], cprecision const *const vals[],
+               precision const x[], precision w1[], precision w2[],
+               std::vector<std::vector<precision>> &tile_wspace)
+{
+  constexpr int64_t block_size = ipow<n, num_dimensions>();
+
+  int const num_tiles = tset.num_tiles();
+
+  int64_t const cache_size = tset.cache_cells * block_size;
 
-        precision *const local_y = y + xidx[row];
+#ifdef _OPENMP
+  int const tid = omp_get_thread_num();
+#else
+  int const tid = 0;
+#endif
 
-        // columns for the 1d pattern, lower part only
-        int col_begin = conn.row_begin(row);
-        int col_end   = conn.row_diag(row);
+  std::vector<precision> &tbuff = tile_wspace[tid];
+  if (static_cast<int64_t>(tbuff.size()) < 2 * cache_size)
+    tbuff.resize(2 * cache_size);
+
+#pragma omp for schedule(dynamic)
+  for (int tile = 0; tile < num_tiles; tile++)
+  {
+    bool const use_cache = (tset.tile_size(tile) <= tset.cache_cells);
 
-        for (int c = col_begin; c < col_end; c++)
+    precision const *src = x;
+    bool src_local       = false;
+    for (int s = 0; s < num_fused; s++)
+    {
+      precision *dest = w1;
+      bool dest_local = false;
+      if (s + 1 < num_fused)
+      {
+        if (use_cache)
         {
-          int64_t const xj = xidx[conn[c]];
-          if (xj != -1)
-          {
-            if constexpr (n == -1)
-#pragma omp atomic
-              ++number_of_blocks_;
-            else
-              gbkron_mult_add<precision, num_dimensions, dim, n>(vals + n2 * c, y + xj, local_y);
-          }
+          dest       = tbuff.data() + (s % 2) * cache_size;
+          dest_local = true;
+        }
+        else // ping-pong between w1 and w2, finishing in w1
+        {
+          dest = ((num_fused - 1 - s) % 2 == 0) ? w1 : w2;
         }
       }
 
-      // restore the entries
-      for (int j = vec_begin; j < vec_end; j++)
-        xidx[dsort(ilist, dim, j)] = -1;
+      tile_sweep_cpu<precision, num_dimensions, n>(
+          dirs[s], tset, tile, *plans[s], vals[s], src, src_local, dest, dest_local);
+
+      src       = dest;
+      src_local = dest_local;
     }
   }
 }
 
-template<typename precision, permutes::matrix_fill fill, int num_dimensions, int dim>
-void global_cpu(int n, vector2d<int> const &ilist, dimension_sort const &dsort,
-                connect_1d const &conn, precision const vals[],
-                precision const x[], precision y[],
-                std::vector<std::vector<int64_t>> &row_wspace)
+template<typename precision, int num_dimensions, typename cprecision>
+void fused_cpu(int n, sweep_tiles::tile_set const &tset, int num_fused, int const dirs[],
+               sweep_plan const *const plans[], cprecision const *const vals[],
+               precision const x[], precision w1[], precision w2[],
+               block_global_workspace<precision> &workspace)
 {
   switch (n)
   {
-  case -1: // special case: count the number of flops
-    global_cpu<precision, fill, num_dimensions, dim, -1>(ilist, dsort, conn, vals, x, y, row_wspace);
+  case 1: // pwconstant
+    fused_cpu<precision, num_dimensions, 1>(tset, num_fused, dirs, plans, vals,
+                                            x, w1, w2, workspace.tile_map);
+    break;
+  case 2: // linear
+    fused_cpu<precision, num_dimensions, 2>(tset, num_fused, dirs, plans, vals,
+                                            x, w1, w2, workspace.tile_map);
+    break;
+  case 3: // quadratic
+    fused_cpu<precision, num_dimensions, 3>(tset, num_fused, dirs, plans, vals,
+                                            x, w1, w2, workspace.tile_map);
+    break;
+  case 4: // cubic
+    fused_cpu<precision, num_dimensions, 4>(tset, num_fused, dirs, plans, vals,
+                                            x, w1, w2, workspace.tile_map);
+    break;
+  default:
+    throw std::runtime_error("(kronmult-fused) unimplemented n for given number of dims");
+  };
+}
+
+template<typename precision, typename cprecision>
+void fused_cpu(int num_dimensions, int n, sweep_tiles::tile_set const &tset,
+               int num_fused, int const dirs[], sweep_plan const *const plans[],
+               cprecision const *const vals[], precision const x[],
+               precision w1[], precision w2[],
+               block_global_workspace<precision> &workspace)
+{
+  switch (num_dimensions)
+  {
+  case 2:
+    fused_cpu<precision, 2>(n, tset, num_fused, dirs, plans, vals, x, w1, w2, workspace);
+    break;
+  case 3:
+    fused_cpu<precision, 3>(n, tset, num_fused, dirs, plans, vals, x, w1, w2, workspace);
+    break;
+  case 4:
+    fused_cpu<precision, 4>(n, tset, num_fused, dirs, plans, vals, x, w1, w2, workspace);
     break;
+  case 5:
+    fused_cpu<precision, 5>(n, tset, num_fused, dirs, plans, vals, x, w1, w2, workspace);
+    break;
+  case 6:
+    fused_cpu<precision, 6>(n, tset, num_fused, dirs, plans, vals, x, w1, w2, workspace);
+    break;
+  default:
+    throw std::runtime_error("(kronmult-fused) works with only 2 - 6 dimensions");
+  };
+}
+
+template<typename precision, int num_dimensions, int dim, typename cprecision>
+void global_cpu(int n, sweep_plan const &plan,
+                cprecision const vals[], precision const x[], precision y[],
+                int num_rhs)
+{
+  switch (n)
+  {
   case 1: // pwconstant
-    global_cpu<precision, fill, num_dimensions, dim, 1>(ilist, dsort, conn, vals, x, y, row_wspace);
+    global_cpu<precision, num_dimensions, dim, 1>(plan, vals, x, y, num_rhs);
     break;
   case 2: // linear
-    global_cpu<precision, fill, num_dimensions, dim, 2>(ilist, dsort, conn, vals, x, y, row_wspace);
+    global_cpu<precision, num_dimensions, dim, 2>(plan, vals, x, y, num_rhs);
     break;
   case 3: // quadratic
-    global_cpu<precision, fill, num_dimensions, dim, 3>(ilist, dsort, conn, vals, x, y, row_wspace);
+    global_cpu<precision, num_dimensions, dim, 3>(plan, vals, x, y, num_rhs);
     break;
   case 4: // cubic
-    global_cpu<precision, fill, num_dimensions, dim, 4>(ilist, dsort, conn, vals, x, y, row_wspace);
+    global_cpu<precision, num_dimensions, dim, 4>(plan, vals, x, y, num_rhs);
     break;
   default:
     throw std::runtime_error("(kronmult) unimplemented n for given number of dims");
@@ -451,62 +862,57 @@ void global_cpu(int n, vector2d<int> const &ilist, dimension_sort const &dsort,
 }
 
 template<typename precision, int num_dimensions, int dim>
-void globalsv_cpu(int n, vector2d<int> const &ilist, dimension_sort const &dsort,
-                  connect_1d const &conn, precision const vals[],
-                  precision y[], std::vector<std::vector<int64_t>> &row_wspace)
+void globalsv_cpu(int n, sweep_plan const &plan,
+                  precision const vals[], precision y[])
 {
   switch (n)
   {
-  case -1: // special case: count the number of flops
-    globalsv_cpu<precision, num_dimensions, dim, -1>(ilist, dsort, conn, vals, y, row_wspace);
-    break;
   case 1: // pwconstant
-    globalsv_cpu<precision, num_dimensions, dim, 1>(ilist, dsort, conn, vals, y, row_wspace);
+    globalsv_cpu<precision, num_dimensions, dim, 1>(plan, vals, y);
     break;
   case 2: // linear
-    globalsv_cpu<precision, num_dimensions, dim, 2>(ilist, dsort, conn, vals, y, row_wspace);
+    globalsv_cpu<precision, num_dimensions, dim, 2>(plan, vals, y);
     break;
   case 3: // quadratic
-    globalsv_cpu<precision, num_dimensions, dim, 3>(ilist, dsort, conn, vals, y, row_wspace);
+    globalsv_cpu<precision, num_dimensions, dim, 3>(plan, vals, y);
     break;
   case 4: // cubic
-    globalsv_cpu<precision, num_dimensions, dim, 4>(ilist, dsort, conn, vals, y, row_wspace);
+    globalsv_cpu<precision, num_dimensions, dim, 4>(plan, vals, y);
     break;
   default:
     throw std::runtime_error("(kronmult-sv) unimplemented n for given number of dims");
   };
 }
 
-template<typename precision, permutes::matrix_fill fill, int num_dimensions>
-void global_cpu(int n, vector2d<int> const &ilist,
-                dimension_sort const &dsort, int dim, connect_1d const &conn,
-                precision const vals[], precision const x[], precision y[],
-                std::vector<std::vector<int64_t>> &row_wspace)
+template<typename precision, int num_dimensions, typename cprecision>
+void global_cpu(int n, int dim, sweep_plan const &plan,
+                cprecision const vals[], precision const x[], precision y[],
+                int num_rhs)
 {
   expect(dim < num_dimensions);
   if constexpr (num_dimensions == 1)
   {
-    global_cpu<precision, fill, num_dimensions, 0>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+    global_cpu<precision, num_dimensions, 0>(n, plan, vals, x, y, num_rhs);
   }
   else if constexpr (num_dimensions == 2)
   {
     if (dim == 0)
-      global_cpu<precision, fill, num_dimensions, 0>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 0>(n, plan, vals, x, y, num_rhs);
     else
-      global_cpu<precision, fill, num_dimensions, 1>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 1>(n, plan, vals, x, y, num_rhs);
   }
   else if constexpr (num_dimensions == 3)
   {
     switch (dim)
     {
     case 0:
-      global_cpu<precision, fill, num_dimensions, 0>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 0>(n, plan, vals, x, y, num_rhs);
       break;
     case 1:
-      global_cpu<precision, fill, num_dimensions, 1>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 1>(n, plan, vals, x, y, num_rhs);
       break;
     default: // case 2:
-      global_cpu<precision, fill, num_dimensions, 2>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 2>(n, plan, vals, x, y, num_rhs);
       break;
     }
   }
@@ -515,16 +921,16 @@ void global_cpu(int n, vector2d<int> const &ilist,
     switch (dim)
     {
     case 0:
-      global_cpu<precision, fill, num_dimensions, 0>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 0>(n, plan, vals, x, y, num_rhs);
       break;
     case 1:
-      global_cpu<precision, fill, num_dimensions, 1>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 1>(n, plan, vals, x, y, num_rhs);
       break;
     case 2:
-      global_cpu<precision, fill, num_dimensions, 2>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 2>(n, plan, vals, x, y, num_rhs);
       break;
     default: // case 3:
-      global_cpu<precision, fill, num_dimensions, 3>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 3>(n, plan, vals, x, y, num_rhs);
       break;
     }
   }
@@ -533,77 +939,76 @@ void global_cpu(int n, vector2d<int> const &ilist,
     switch (dim)
     {
     case 0:
-      global_cpu<precision, fill, num_dimensions, 0>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 0>(n, plan, vals, x, y, num_rhs);
       break;
     case 1:
-      global_cpu<precision, fill, num_dimensions, 1>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 1>(n, plan, vals, x, y, num_rhs);
       break;
     case 2:
-      global_cpu<precision, fill, num_dimensions, 2>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 2>(n, plan, vals, x, y, num_rhs);
       break;
     case 3:
-      global_cpu<precision, fill, num_dimensions, 3>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 3>(n, plan, vals, x, y, num_rhs);
       break;
     default: // case 4:
-      global_cpu<precision, fill, num_dimensions, 4>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 4>(n, plan, vals, x, y, num_rhs);
       break;
     }
   }
-  else // num_dimensions == 6
+  else if constexpr (num_dimensions == 6)
   {
     switch (dim)
     {
     case 0:
-      global_cpu<precision, fill, num_dimensions, 0>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 0>(n, plan, vals, x, y, num_rhs);
       break;
     case 1:
-      global_cpu<precision, fill, num_dimensions, 1>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 1>(n, plan, vals, x, y, num_rhs);
       break;
     case 2:
-      global_cpu<precision, fill, num_dimensions, 2>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 2>(n, plan, vals, x, y, num_rhs);
       break;
     case 3:
-      global_cpu<precision, fill, num_dimensions, 3>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 3>(n, plan, vals, x, y, num_rhs);
       break;
     case 4:
-      global_cpu<precision, fill, num_dimensions, 4>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 4>(n, plan, vals, x, y, num_rhs);
       break;
     default: // case 5:
-      global_cpu<precision, fill, num_dimensions, 5>(n, ilist, dsort, conn, vals, x, y, row_wspace);
+      global_cpu<precision, num_dimensions, 5>(n, plan, vals, x, y, num_rhs);
       break;
     }
   }
 }
 
 template<typename precision, int num_dimensions>
-void globalsv_cpu(int n, vector2d<int> const &ilist, dimension_sort const &dsort,
-                  int dim, connect_1d const &conn, precision const vals[],
-                  precision y[], std::vector<std::vector<int64_t>> &row_wspace)
+void globalsv_cpu(int n, int dim, sweep_plan const &plan,
+                  precision const vals[], precision y[])
 {
   expect(dim < num_dimensions);
   if constexpr (num_dimensions == 1)
   {
-    globalsv_cpu<precision, num_dimensions, 0>(n, ilist, dsort, conn, vals, y, row_wspace);
+    globalsv_cpu<precision, num_dimensions, 0>(n, plan, vals, y);
   }
   else if constexpr (num_dimensions == 2)
   {
     if (dim == 0)
-      globalsv_cpu<precision, num_dimensions, 0>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 0>(n, plan, vals, y);
     else
-      globalsv_cpu<precision, num_dimensions, 1>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 1>(n, plan, vals, y);
   }
   else if constexpr (num_dimensions == 3)
   {
     switch (dim)
     {
     case 0:
-      globalsv_cpu<precision, num_dimensions, 0>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 0>(n, plan, vals, y);
       break;
     case 1:
-      globalsv_cpu<precision, num_dimensions, 1>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 1>(n, plan, vals, y);
       break;
     default: // case 2:
-      globalsv_cpu<precision, num_dimensions, 2>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 2>(n, plan, vals, y);
       break;
     }
   }
@@ -612,16 +1017,16 @@ void globalsv_cpu(int n, vector2d<int> const &ilist, dimension_sort const &dsort
     switch (dim)
     {
     case 0:
-      globalsv_cpu<precision, num_dimensions, 0>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 0>(n, plan, vals, y);
       break;
     case 1:
-      globalsv_cpu<precision, num_dimensions, 1>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 1>(n, plan, vals, y);
       break;
     case 2:
-      globalsv_cpu<precision, num_dimensions, 2>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 2>(n, plan, vals, y);
       break;
     default: // case 3:
-      globalsv_cpu<precision, num_dimensions, 3>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 3>(n, plan, vals, y);
       break;
     }
   }
@@ -630,147 +1035,257 @@ void globalsv_cpu(int n, vector2d<int> const &ilist, dimension_sort const &dsort
     switch (dim)
     {
     case 0:
-      globalsv_cpu<precision, num_dimensions, 0>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 0>(n, plan, vals, y);
       break;
     case 1:
-      globalsv_cpu<precision, num_dimensions, 1>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 1>(n, plan, vals, y);
       break;
     case 2:
-      globalsv_cpu<precision, num_dimensions, 2>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 2>(n, plan, vals, y);
       break;
     case 3:
-      globalsv_cpu<precision, num_dimensions, 3>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 3>(n, plan, vals, y);
       break;
     default: // case 4:
-      globalsv_cpu<precision, num_dimensions, 4>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 4>(n, plan, vals, y);
       break;
     }
   }
-  else // num_dimensions == 6
+  else if constexpr (num_dimensions == 6)
   {
     switch (dim)
     {
     case 0:
-      globalsv_cpu<precision, num_dimensions, 0>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 0>(n, plan, vals, y);
       break;
     case 1:
-      globalsv_cpu<precision, num_dimensions, 1>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 1>(n, plan, vals, y);
       break;
     case 2:
-      globalsv_cpu<precision, num_dimensions, 2>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 2>(n, plan, vals, y);
       break;
     case 3:
-      globalsv_cpu<precision, num_dimensions, 3>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 3>(n, plan, vals, y);
       break;
     case 4:
-      globalsv_cpu<precision, num_dimensions, 4>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 4>(n, plan, vals, y);
       break;
     default: // case 5:
-      globalsv_cpu<precision, num_dimensions, 5>(n, ilist, dsort, conn, vals, y, row_wspace);
+      globalsv_cpu<precision, num_dimensions, 5>(n, plan, vals, y);
       break;
     }
   }
 }
 
-template<typename precision, permutes::matrix_fill fill>
-void global_cpu(int num_dimensions, int n, vector2d<int> const &ilist,
-                dimension_sort const &dsort, int dim, connect_1d const &conn,
-                precision const vals[], precision const x[], precision y[],
-                std::vector<std::vector<int64_t>> &row_wspace)
+/*!
+ * \brief Sweep in the direction of the plan, called by all threads of the team.
+ *
+ * The plans must be obtained from get_sweep_plan() before the parallel region,
+ * since the cache of plans is not thread-safe.
+ */
+template<typename precision, typename cprecision>
+void global_cpu(int num_dimensions, int n, sweep_plan const &plan,
+                cprecision const vals[], precision const x[], precision y[],
+                int num_rhs = 1)
 {
+  int const dim = plan.dim;
   switch (num_dimensions)
   {
   case 1:
-    global_cpu<precision, fill, 1>(n, ilist, dsort, dim, conn, vals, x, y, row_wspace);
+    global_cpu<precision, 1>(n, dim, plan, vals, x, y, num_rhs);
     break;
   case 2:
-    global_cpu<precision, fill, 2>(n, ilist, dsort, dim, conn, vals, x, y, row_wspace);
+    global_cpu<precision, 2>(n, dim, plan, vals, x, y, num_rhs);
     break;
   case 3:
-    global_cpu<precision, fill, 3>(n, ilist, dsort, dim, conn, vals, x, y, row_wspace);
+    global_cpu<precision, 3>(n, dim, plan, vals, x, y, num_rhs);
     break;
   case 4:
-    global_cpu<precision, fill, 4>(n, ilist, dsort, dim, conn, vals, x, y, row_wspace);
+    global_cpu<precision, 4>(n, dim, plan, vals, x, y, num_rhs);
     break;
   case 5:
-    global_cpu<precision, fill, 5>(n, ilist, dsort, dim, conn, vals, x, y, row_wspace);
+    global_cpu<precision, 5>(n, dim, plan, vals, x, y, num_rhs);
     break;
   case 6:
-    global_cpu<precision, fill, 6>(n, ilist, dsort, dim, conn, vals, x, y, row_wspace);
+    global_cpu<precision, 6>(n, dim, plan, vals, x, y, num_rhs);
     break;
   default:
     throw std::runtime_error("(kronmult) works with only up to 6 dimensions");
   };
 }
 
+//! \brief Solve in the direction of the plan, the plan must use the lower part of the pattern.
 template<typename precision>
-void globalsv_cpu(int num_dimensions, int n, vector2d<int> const &ilist,
-                  dimension_sort const &dsort, int dim, connect_1d const &conn,
-                  precision const vals[], precision y[],
-                  std::vector<std::vector<int64_t>> &row_wspace)
+void globalsv_cpu(int num_dimensions, int n, sweep_plan const &plan,
+                  precision const vals[], precision y[])
 {
+  int const dim = plan.dim;
   switch (num_dimensions)
   {
   case 1:
-    globalsv_cpu<precision, 1>(n, ilist, dsort, dim, conn, vals, y, row_wspace);
+    globalsv_cpu<precision, 1>(n, dim, plan, vals, y);
     break;
   case 2:
-    globalsv_cpu<precision, 2>(n, ilist, dsort, dim, conn, vals, y, row_wspace);
+    globalsv_cpu<precision, 2>(n, dim, plan, vals, y);
     break;
   case 3:
-    globalsv_cpu<precision, 3>(n, ilist, dsort, dim, conn, vals, y, row_wspace);
+    globalsv_cpu<precision, 3>(n, dim, plan, vals, y);
     break;
   case 4:
-    globalsv_cpu<precision, 4>(n, ilist, dsort, dim, conn, vals, y, row_wspace);
+    globalsv_cpu<precision, 4>(n, dim, plan, vals, y);
     break;
   case 5:
-    globalsv_cpu<precision, 5>(n, ilist, dsort, dim, conn, vals, y, row_wspace);
+    globalsv_cpu<precision, 5>(n, dim, plan, vals, y);
     break;
   case 6:
-    globalsv_cpu<precision, 6>(n, ilist, dsort, dim, conn, vals, y, row_wspace);
+    globalsv_cpu<precision, 6>(n, dim, plan, vals, y);
     break;
   default:
     throw std::runtime_error("(kronmult) works with only up to 6 dimensions");
   };
 }
 
-template<typename precision>
-void global_cpu(int num_dimensions, int n, vector2d<int> const &ilist,
-                dimension_sort const &dsort, int dim, permutes::matrix_fill fill,
-                connect_1d const &conn, precision const vals[], precision const x[],
-                precision y[], std::vector<std::vector<int64_t>> &row_wspace)
+sweep_tiles::sweep_tiles(vector2d<int> const &ilist, std::vector<permutes> const &perms,
+                         int64_t block_bytes, int64_t cache_bytes, int min_tiles)
 {
-  switch (fill)
+  int const num_dimensions = ilist.stride();
+  int const num_cells      = ilist.num_strips();
+  if (num_dimensions < 2 or num_cells == 0)
+    return;
+
+  if (min_tiles < 0)
   {
-  case permutes::matrix_fill::lower:
-    global_cpu<precision, permutes::matrix_fill::lower>(num_dimensions, n, ilist, dsort, dim, conn, vals, x, y, row_wspace);
-    break;
-  case permutes::matrix_fill::upper:
-    global_cpu<precision, permutes::matrix_fill::upper>(num_dimensions, n, ilist, dsort, dim, conn, vals, x, y, row_wspace);
-    break;
-  default: // case permutes::matrix_fill::both:
-    global_cpu<precision, permutes::matrix_fill::both>(num_dimensions, n, ilist, dsort, dim, conn, vals, x, y, row_wspace);
-    break;
+#ifdef _OPENMP
+    min_tiles = 4 * omp_get_max_threads();
+#else
+    min_tiles = 1;
+#endif
+  }
+
+  // lexicographical compare using first the directions outside of the mask
+  // then the directions inside the mask with dimension d being the fastest
+  auto compare = [&](int mask, int d, int a, int b) -> int {
+    int const *idxa = ilist[a];
+    int const *idxb = ilist[b];
+    for (int j = 0; j < num_dimensions; j++)
+      if (not(mask & (1 << j)) and idxa[j] != idxb[j])
+        return (idxa[j] < idxb[j]) ? -1 : 1;
+    for (int j = 0; j < num_dimensions; j++)
+      if (j != d and (mask & (1 << j)) and idxa[j] != idxb[j])
+        return (idxa[j] < idxb[j]) ? -2 : 2;
+    if (d >= 0 and idxa[d] != idxb[d])
+      return (idxa[d] < idxb[d]) ? -3 : 3;
+    return 0;
+  };
+
+  std::vector<int> rejected;
+
+  // returns true if the set was accepted
+  auto build_set = [&](int mask) -> bool {
+    tile_set tset;
+    tset.mask = mask;
+
+    std::vector<int> order(num_cells);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b) -> bool {
+      return (compare(mask, -1, a, b) < 0);
+    });
+
+    tset.tpntr.push_back(0);
+    for (int j = 1; j < num_cells; j++)
+      if (std::abs(compare(mask, -1, order[j - 1], order[j])) == 1)
+        tset.tpntr.push_back(j);
+    tset.tpntr.push_back(num_cells);
+
+    int const num_tiles = tset.num_tiles();
+    if (num_tiles < min_tiles or (2 * block_bytes * num_cells) / num_tiles > cache_bytes)
+      return false;
+
+    // the thread-local buffers do not need to exceed the largest tile
+    int max_tile = 1;
+    for (int t = 0; t < num_tiles; t++)
+      max_tile = std::max(max_tile, tset.tile_size(t));
+    tset.cache_cells = static_cast<int>(std::min(int64_t{max_tile},
+                                                 std::max(int64_t{1}, cache_bytes / (2 * block_bytes))));
+
+    tset.local.resize(num_cells);
+    for (int t = 0; t < num_tiles; t++)
+      for (int j = tset.tpntr[t]; j < tset.tpntr[t + 1]; j++)
+        tset.local[order[j]] = j - tset.tpntr[t];
+
+    for (int d = 0; d < num_dimensions; d++)
+    {
+      if (not(mask & (1 << d)))
+        continue;
+
+      std::vector<int> &lcells = tset.lcells[d];
+      std::vector<int> &lpntr  = tset.lpntr[d];
+      std::vector<int> &tlines = tset.tlines[d];
+
+      lcells = order;
+      lpntr.push_back(0);
+      tlines.push_back(0);
+      for (int t = 0; t < num_tiles; t++)
+      {
+        int const tbegin = tset.tpntr[t];
+        int const tend   = tset.tpntr[t + 1];
+        std::sort(lcells.begin() + tbegin, lcells.begin() + tend, [&](int a, int b) -> bool {
+          return (compare(mask, d, a, b) < 0);
+        });
+        for (int j = tbegin + 1; j < tend; j++)
+          if (std::abs(compare(mask, d, lcells[j - 1], lcells[j])) < 3)
+            lpntr.push_back(j);
+        lpntr.push_back(tend);
+        tlines.push_back(static_cast<int>(lpntr.size()) - 1);
+      }
+    }
+
+    sets_.emplace_back(std::move(tset));
+    return true;
+  };
+
+  for (auto const &perm : perms)
+  {
+    for (auto const &dirs : perm.direction)
+    {
+      // try the largest set first
+      for (int p = static_cast<int>(dirs.size()); p > 1; p--)
+      {
+        int const mask = direction_mask(dirs, p);
+        if (std::any_of(sets_.begin(), sets_.end(),
+                        [&](tile_set const &s) -> bool { return (s.mask == mask); }))
+          break;
+        if (std::find(rejected.begin(), rejected.end(), mask) != rejected.end())
+          continue;
+        if (build_set(mask))
+          break;
+        rejected.push_back(mask);
+      }
+    }
   }
 }
 
-template<typename precision>
-void global_cpu(int num_dimensions, int n, int64_t block_size,
-                vector2d<int> const &ilist, dimension_sort const &dsort,
-                std::vector<permutes> const &perms,
-                std::vector<int> const &flux_dir,
-                connect_1d const &conn_volumes, connect_1d const &conn_full,
-                std::vector<std::vector<precision>> const &gvals,
-                std::vector<int> const &terms,
-                precision const x[], precision y[],
-                block_global_workspace<precision> &workspace)
+/*!
+ * \brief Applies the terms to num_rhs interleaved vectors.
+ *
+ * The tiles are used only for a single vector, the tile buffers are sized
+ * for one vector and multiple vectors already raise the arithmetic intensity.
+ */
+template<typename precision, typename cprecision>
+void global_cpu_terms(int num_dimensions, int n, int64_t block_size,
+                      vector2d<int> const &ilist, dimension_sort const &dsort,
+                      std::vector<permutes> const &perms,
+                      std::vector<int> const &flux_dir,
+                      connect_1d const &conn_volumes, connect_1d const &conn_full,
+                      std::vector<std::vector<cprecision>> const &gvals,
+                      std::vector<int> const &terms, sweep_tiles const &tiles,
+                      int num_rhs, precision const x[], precision y[],
+                      block_global_workspace<precision> &workspace)
 {
-  int64_t const num_entries = block_size * ilist.num_strips();
+  int64_t const num_entries = block_size * ilist.num_strips() * num_rhs;
 
-  if (static_cast<int64_t>(workspace.w1.size()) < num_entries)
-    workspace.w1.resize(num_entries);
-  if (static_cast<int64_t>(workspace.w2.size()) < num_entries)
-    workspace.w2.resize(num_entries);
+  first_touch_resize(workspace.w1, num_entries);
+  first_touch_resize(workspace.w2, num_entries);
 
   precision *w1 = workspace.w1.data();
   precision *w2 = workspace.w2.data();
@@ -786,50 +1301,190 @@ void global_cpu(int num_dimensions, int n, int64_t block_size,
       return conn_volumes;
   };
 
+  // the cache of plans is not thread-safe, collect the plans and values
+  // for all sweeps before starting the team
+  std::vector<sweep_plan const *> stage_plans;
+  std::vector<cprecision const *> stage_vals;
   for (int t : terms)
   {
-    // terms can have different effective dimension, since some of them are identity
-    permutes const &perm  = perms[t];
-    int const active_dims = perm.num_dimensions();
-    if (active_dims == 0)
-      continue;
-
+    permutes const &perm = perms[t];
     for (size_t i = 0; i < perm.fill.size(); i++)
     {
-      int dir = perm.direction[i][0];
+      for (int d = 0; d < perm.num_dimensions(); d++)
+      {
+        int const dir = perm.direction[i][d];
+        stage_plans.push_back(&get_sweep_plan(workspace.plans, ilist, dsort, dir, perm.fill[i][d],
+                                              get_connect_1d(flux_dir[t], perm.fill[i][d])));
+        stage_vals.push_back(gvals[t * num_dimensions + dir].data());
+      }
+    }
+  }
+
+#ifdef _OPENMP
+  if (static_cast<int>(workspace.tile_map.size()) < omp_get_max_threads())
+    workspace.tile_map.resize(omp_get_max_threads());
+#else
+  if (workspace.tile_map.empty())
+    workspace.tile_map.resize(1);
+#endif
+
+  // a single team runs all sweeps, the barriers separate the directions
+#pragma omp parallel
+  {
+    precision *tw1 = w1;
+    precision *tw2 = w2;
 
-      global_cpu(num_dimensions, n, ilist, dsort, dir, perm.fill[i][0],
-                 get_connect_1d(flux_dir[t], perm.fill[i][0]),
-                 gvals[t * num_dimensions + dir].data(), x, w1, workspace.row_map);
+    size_t stage = 0;
+    for (int t : terms)
+    {
+      // terms can have different effective dimension, since some of them are identity
+      permutes const &perm  = perms[t];
+      int const active_dims = perm.num_dimensions();
+      if (active_dims == 0)
+        continue;
 
-      for (int d = 1; d < active_dims; d++)
+      for (size_t i = 0; i < perm.fill.size(); i++)
       {
-        dir = perm.direction[i][d];
-        global_cpu(num_dimensions, n, ilist, dsort, dir, perm.fill[i][d],
-                   get_connect_1d(flux_dir[t], perm.fill[i][d]),
-                   gvals[t * num_dimensions + dir].data(), w1, w2, workspace.row_map);
-        std::swap(w1, w2);
+        int num_fused = 1;
+        sweep_tiles::tile_set const *tset =
+            (num_rhs == 1) ? tiles.find(perm.direction[i], num_fused) : nullptr;
+
+        if (tset != nullptr)
+        {
+          // the dynamic loop over the tiles ends with a barrier
+          fused_cpu(num_dimensions, n, *tset, num_fused, perm.direction[i].data(),
+                    stage_plans.data() + stage, stage_vals.data() + stage,
+                    x, tw1, tw2, workspace);
+        }
+        else
+        {
+          global_cpu(num_dimensions, n, *stage_plans[stage], stage_vals[stage],
+                     x, tw1, num_rhs);
+#pragma omp barrier
+        }
+
+        for (int d = num_fused; d < active_dims; d++)
+        {
+          global_cpu(num_dimensions, n, *stage_plans[stage + d], stage_vals[stage + d],
+                     tw1, tw2, num_rhs);
+#pragma omp barrier
+          std::swap(tw1, tw2);
+        }
+        stage += active_dims;
+
+#pragma omp for schedule(static)
+        for (int64_t j = 0; j < num_entries; j++)
+          y[j] += tw1[j];
       }
+    }
+  }
+}
 
-#pragma omp parallel for
-      for (int64_t j = 0; j < num_entries; j++)
-        y[j] += w1[j];
+template<typename precision, typename cprecision>
+void global_cpu(int num_dimensions, int n, int64_t block_size,
+                vector2d<int> const &ilist, dimension_sort const &dsort,
+                std::vector<permutes> const &perms,
+                std::vector<int> const &flux_dir,
+                connect_1d const &conn_volumes, connect_1d const &conn_full,
+                std::vector<std::vector<cprecision>> const &gvals,
+                std::vector<int> const &terms, sweep_tiles const &tiles,
+                precision const x[], precision y[],
+                block_global_workspace<precision> &workspace)
+{
+  global_cpu_terms(num_dimensions, n, block_size, ilist, dsort, perms, flux_dir,
+                   conn_volumes, conn_full, gvals, terms, tiles, 1, x, y, workspace);
+}
+
+template<typename precision, typename cprecision>
+void global_cpu(int num_dimensions, int n, int64_t block_size,
+                vector2d<int> const &ilist, dimension_sort const &dsort,
+                std::vector<permutes> const &perms,
+                std::vector<int> const &flux_dir,
+                connect_1d const &conn_volumes, connect_1d const &conn_full,
+                std::vector<std::vector<cprecision>> const &gvals,
+                std::vector<int> const &terms, int num_rhs,
+                precision const x[], precision y[],
+                block_global_workspace<precision> &workspace)
+{
+  global_cpu_terms(num_dimensions, n, block_size, ilist, dsort, perms, flux_dir,
+                   conn_volumes, conn_full, gvals, terms, sweep_tiles(), num_rhs,
+                   x, y, workspace);
+}
+
+//! \brief Returns the plans for all directions of all permutations, in order.
+std::vector<sweep_plan const *>
+collect_plans(vector2d<int> const &ilist, dimension_sort const &dsort,
+              permutes const &perm, connect_1d const &vconn,
+              std::deque<sweep_plan> &plans)
+{
+  std::vector<sweep_plan const *> result;
+  result.reserve(perm.fill.size() * perm.num_dimensions());
+  for (size_t i = 0; i < perm.fill.size(); i++)
+    for (int d = 0; d < perm.num_dimensions(); d++)
+      result.push_back(&get_sweep_plan(plans, ilist, dsort, perm.direction[i][d],
+                                       perm.fill[i][d], vconn));
+  return result;
+}
+
+/*!
+ * \brief Counts the connected pairs of cells for the sweep in direction dim.
+ *
+ * Gives the same count as sweep_plan::num_connections() without building the plan,
+ * each thread counts its own vectors of the dimension sort.
+ */
+int64_t count_connections(vector2d<int> const &ilist, dimension_sort const &dsort, int dim,
+                          permutes::matrix_fill fill, connect_1d const &conn)
+{
+  int64_t num_connect = 0;
+  int const num_vecs  = dsort.num_vecs(dim);
+
+#pragma omp parallel reduction(+ : num_connect)
+  {
+    // marks the entries of the 1d pattern that are present in the current vector
+    std::vector<int> present(conn.num_rows(), 0);
+
+#pragma omp for schedule(static)
+    for (int vec_id = 0; vec_id < num_vecs; vec_id++)
+    {
+      int const vec_begin = dsort.vec_begin(dim, vec_id);
+      int const vec_end   = dsort.vec_end(dim, vec_id);
+      for (int j = vec_begin; j < vec_end; j++)
+        present[dsort(ilist, dim, j)] = 1;
+
+      for (int rj = vec_begin; rj < vec_end; rj++)
+      {
+        int const row = dsort(ilist, dim, rj);
+
+        int col_begin = (fill == permutes::matrix_fill::upper) ? conn.row_diag(row) : conn.row_begin(row);
+        int col_end   = (fill == permutes::matrix_fill::lower) ? conn.row_diag(row) : conn.row_end(row);
+
+        for (int j = col_begin; j < col_end; j++)
+          num_connect += present[conn[j]];
+      }
+
+      for (int j = vec_begin; j < vec_end; j++)
+        present[dsort(ilist, dim, j)] = 0;
     }
   }
+
+  return num_connect;
 }
 
 template<typename precision>
-int64_t block_global_count_flops(
-    int num_dimensions, int64_t block_size,
+kron_roofline block_global_roofline(
+    int num_dimensions, int n, int64_t block_size,
     vector2d<int> const &ilist, dimension_sort const &dsort,
     std::vector<permutes> const &perms,
     std::vector<int> const &flux_dir,
     connect_1d const &conn_volumes, connect_1d const &conn_full,
-    std::vector<int> const &terms,
-    block_global_workspace<precision> &workspace)
+    std::vector<int> const &terms, int coeff_bytes)
 {
-  number_of_blocks_ = 0;
+  expect(num_dimensions == ilist.stride());
+
+  int64_t const num_cells = ilist.num_strips();
+  int64_t const vec_bytes = num_cells * block_size * static_cast<int64_t>(sizeof(precision));
 
+  kron_roofline result;
   for (int const t : terms)
   {
     // terms can have different effective dimension, since some of them are identity
@@ -842,14 +1497,28 @@ int64_t block_global_count_flops(
     {
       for (int d = 0; d < active_dims; d++)
       {
-        global_cpu<precision>(num_dimensions, -1, ilist, dsort, perm.direction[i][d], perm.fill[i][d],
-                              (perm.fill[i][d] == permutes::matrix_fill::both and flux_dir[t] != -1) ? conn_full : conn_volumes,
-                              nullptr, nullptr, nullptr, workspace.row_map);
+        permutes::matrix_fill const fill = perm.fill[i][d];
+        connect_1d const &conn = (fill == permutes::matrix_fill::both and flux_dir[t] != -1) ? conn_full : conn_volumes;
+
+        int64_t const num_connect =
+            count_connections(ilist, dsort, perm.direction[i][d], fill, conn);
+
+        // each connection is an n by n matrix times the n by (block_size / n) block
+        result.flops += 2 * n * block_size * num_connect;
+
+        // read the input, read and write the output
+        result.bytes += 3 * vec_bytes;
+        // columns and coefficient offsets, row pointers and row indexes
+        result.bytes += num_connect * 2 * static_cast<int64_t>(sizeof(int));
+        result.bytes += num_cells * static_cast<int64_t>(sizeof(int64_t) + sizeof(int));
+        // the used 1d coefficients are loaded once
+        result.bytes += std::min(num_connect, static_cast<int64_t>(conn.num_connections()))
+                        * n * n * coeff_bytes;
       }
     }
   }
 
-  return number_of_blocks_ * block_size;
+  return result;
 }
 
 template<typename precision>
@@ -861,10 +1530,8 @@ void global_cpu(int num_dimensions, int n, int64_t block_size,
 {
   int64_t const num_entries = block_size * ilist.num_strips();
 
-  if (static_cast<int64_t>(workspace.w1.size()) < num_entries)
-    workspace.w1.resize(num_entries);
-  if (static_cast<int64_t>(workspace.w2.size()) < num_entries)
-    workspace.w2.resize(num_entries);
+  first_touch_resize(workspace.w1, num_entries);
+  first_touch_resize(workspace.w2, num_entries);
 
   precision *w1 = workspace.w1.data();
   precision *w2 = workspace.w2.data();
@@ -873,39 +1540,44 @@ void global_cpu(int num_dimensions, int n, int64_t block_size,
   expect(num_dimensions == perm.num_dimensions());
 
   size_t const num_perms = perm.fill.size();
-  for (size_t i = 0; i < num_perms; i++)
-  {
-    auto &dir = perm.direction[i];
 
-    global_cpu(num_dimensions, n, ilist, dsort, dir[0], perm.fill[i][0],
-               vconn, gvals, x, w1, workspace.row_map);
+  std::vector<sweep_plan const *> const stage_plans =
+      collect_plans(ilist, dsort, perm, vconn, workspace.plans);
 
-    for (int d = 1; d < num_dimensions; d++)
-    {
-      global_cpu(num_dimensions, n, ilist, dsort, dir[d], perm.fill[i][d],
-                 vconn, gvals, w1, w2, workspace.row_map);
-      std::swap(w1, w2);
-    }
+  // a single team runs all sweeps, the barriers separate the directions
+#pragma omp parallel
+  {
+    precision *tw1 = w1;
+    precision *tw2 = w2;
 
-    if (i == 0)
+    for (size_t i = 0; i < num_perms; i++)
     {
-      if (perm.fill.size() == 1)
-#pragma omp parallel for
-        for (int64_t j = 0; j < num_entries; j++)
-          y[j] = alpha * w1[j];
-      else
-        std::copy_n(w1, num_entries, y);
-    }
-    else
-    {
-      if (i + 1 == num_perms)
-#pragma omp parallel for
+      sweep_plan const *const *plans = stage_plans.data() + i * num_dimensions;
+
+      global_cpu(num_dimensions, n, *plans[0], gvals, x, tw1);
+#pragma omp barrier
+
+      for (int d = 1; d < num_dimensions; d++)
+      {
+        global_cpu(num_dimensions, n, *plans[d], gvals, tw1, tw2);
+#pragma omp barrier
+        std::swap(tw1, tw2);
+      }
+
+      if (i == 0)
+      {
+        precision const scale = (num_perms == 1) ? alpha : precision{1};
+#pragma omp for schedule(static)
         for (int64_t j = 0; j < num_entries; j++)
-          y[j] = alpha * (y[j] + w1[j]);
+          y[j] = scale * tw1[j];
+      }
       else
-#pragma omp parallel for
+      {
+        precision const scale = (i + 1 == num_perms) ? alpha : precision{1};
+#pragma omp for schedule(static)
         for (int64_t j = 0; j < num_entries; j++)
-          y[j] += w1[j];
+          y[j] = scale * (y[j] + tw1[j]);
+      }
     }
   }
 }
@@ -919,10 +1591,8 @@ void global_cpu(int num_dimensions, int n, int64_t block_size,
 {
   int64_t const num_entries = block_size * ilist.num_strips();
 
-  if (static_cast<int64_t>(workspace.w1.size()) < num_entries)
-    workspace.w1.resize(num_entries);
-  if (static_cast<int64_t>(workspace.w2.size()) < num_entries)
-    workspace.w2.resize(num_entries);
+  first_touch_resize(workspace.w1, num_entries);
+  first_touch_resize(workspace.w2, num_entries);
 
   precision *w1 = workspace.w1.data();
   precision *w2 = workspace.w2.data();
@@ -930,26 +1600,44 @@ void global_cpu(int num_dimensions, int n, int64_t block_size,
   // terms can have different effective dimension, since some of them are identity
   expect(num_dimensions == perm.num_dimensions());
 
-  for (size_t i = 0; i < perm.fill.size(); i++)
-  {
-    auto &dir = perm.direction[i];
+  size_t const num_perms = perm.fill.size();
+
+  std::vector<sweep_plan const *> const stage_plans =
+      collect_plans(ilist, dsort, perm, vconn, workspace.plans);
 
-    global_cpu(num_dimensions, n, ilist, dsort, dir[0], perm.fill[i][0],
-               vconn, gvals, x, w1, workspace.row_map);
+  // a single team runs all sweeps, the barriers separate the directions
+#pragma omp parallel
+  {
+    precision *tw1 = w1;
+    precision *tw2 = w2;
 
-    for (int d = 1; d < num_dimensions; d++)
+    for (size_t i = 0; i < num_perms; i++)
     {
-      global_cpu(num_dimensions, n, ilist, dsort, dir[d], perm.fill[i][d],
-                 vconn, gvals, w1, w2, workspace.row_map);
-      std::swap(w1, w2);
-    }
+      sweep_plan const *const *plans = stage_plans.data() + i * num_dimensions;
 
-    if (i == 0)
-      std::copy_n(w1, num_entries, y);
-    else
-#pragma omp parallel for
-      for (int64_t j = 0; j < num_entries; j++)
-        y[j] += w1[j];
+      global_cpu(num_dimensions, n, *plans[0], gvals, x, tw1);
+#pragma omp barrier
+
+      for (int d = 1; d < num_dimensions; d++)
+      {
+        global_cpu(num_dimensions, n, *plans[d], gvals, tw1, tw2);
+#pragma omp barrier
+        std::swap(tw1, tw2);
+      }
+
+      if (i == 0)
+      {
+#pragma omp for schedule(static)
+        for (int64_t j = 0; j < num_entries; j++)
+          y[j] = tw1[j];
+      }
+      else
+      {
+#pragma omp for schedule(static)
+        for (int64_t j = 0; j < num_entries; j++)
+          y[j] += tw1[j];
+      }
+    }
   }
 }
 
@@ -959,8 +1647,19 @@ void globalsv_cpu(int num_dimensions, int n, vector2d<int> const &ilist,
                   precision const gvals[], precision y[],
                   block_global_workspace<precision> &workspace)
 {
+  std::vector<sweep_plan const *> plans(num_dimensions);
   for (int d = 0; d < num_dimensions; d++)
-    globalsv_cpu(num_dimensions, n, ilist, dsort, d, vconn, gvals, y, workspace.row_map);
+    plans[d] = &get_sweep_plan(workspace.plans, ilist, dsort, d,
+                               permutes::matrix_fill::lower, vconn);
+
+#pragma omp parallel
+  {
+    for (int d = 0; d < num_dimensions; d++)
+    {
+      globalsv_cpu(num_dimensions, n, *plans[d], gvals, y);
+#pragma omp barrier
+    }
+  }
 }
 
 #ifdef ASGARD_ENABLE_DOUBLE
@@ -970,17 +1669,40 @@ template void global_cpu<double>(int, int, int64_t,
                                  std::vector<permutes> const &,
                                  std::vector<int> const &, connect_1d const &,
                                  connect_1d const &, std::vector<std::vector<double>> const &,
-                                 std::vector<int> const &, double const[], double[],
+                                 std::vector<int> const &, sweep_tiles const &, double const[], double[],
                                  block_global_workspace<double> &);
 
-template int64_t block_global_count_flops<double>(
-    int num_dimensions, int64_t block_size,
+template void global_cpu<double>(int, int, int64_t,
+                                 vector2d<int> const &, dimension_sort const &,
+                                 std::vector<permutes> const &,
+                                 std::vector<int> const &, connect_1d const &,
+                                 connect_1d const &, std::vector<std::vector<double>> const &,
+                                 std::vector<int> const &, int, double const[], double[],
+                                 block_global_workspace<double> &);
+
+template void global_cpu<double, float>(int, int, int64_t,
+                                        vector2d<int> const &, dimension_sort const &,
+                                        std::vector<permutes> const &,
+                                        std::vector<int> const &, connect_1d const &,
+                                        connect_1d const &, std::vector<std::vector<float>> const &,
+                                        std::vector<int> const &, sweep_tiles const &, double const[], double[],
+                                        block_global_workspace<double> &);
+
+template void global_cpu<double, float>(int, int, int64_t,
+                                        vector2d<int> const &, dimension_sort const &,
+                                        std::vector<permutes> const &,
+                                        std::vector<int> const &, connect_1d const &,
+                                        connect_1d const &, std::vector<std::vector<float>> const &,
+                                        std::vector<int> const &, int, double const[], double[],
+                                        block_global_workspace<double> &);
+
+template kron_roofline block_global_roofline<double>(
+    int num_dimensions, int n, int64_t block_size,
     vector2d<int> const &ilist, dimension_sort const &dsort,
     std::vector<permutes> const &perms,
     std::vector<int> const &flux_dir,
     connect_1d const &conn_volumes, connect_1d const &conn_full,
-    std::vector<int> const &terms,
-    block_global_workspace<double> &workspace);
+    std::vector<int> const &terms, int coeff_bytes);
 
 template void global_cpu<double>(
     int, int, int64_t, vector2d<int> const &, dimension_sort const &,
@@ -1005,17 +1727,24 @@ template void global_cpu<float>(int, int, int64_t,
                                 std::vector<permutes> const &,
                                 std::vector<int> const &, connect_1d const &,
                                 connect_1d const &, std::vector<std::vector<float>> const &,
-                                std::vector<int> const &, float const[], float[],
+                                std::vector<int> const &, sweep_tiles const &, float const[], float[],
                                 block_global_workspace<float> &);
 
-template int64_t block_global_count_flops<float>(
-    int num_dimensions, int64_t block_size,
+template void global_cpu<float>(int, int, int64_t,
+                                vector2d<int> const &, dimension_sort const &,
+                                std::vector<permutes> const &,
+                                std::vector<int> const &, connect_1d const &,
+                                connect_1d const &, std::vector<std::vector<float>> const &,
+                                std::vector<int> const &, int, float const[], float[],
+                                block_global_workspace<float> &);
+
+template kron_roofline block_global_roofline<float>(
+    int num_dimensions, int n, int64_t block_size,
     vector2d<int> const &ilist, dimension_sort const &dsort,
     std::vector<permutes> const &perms,
     std::vector<int> const &flux_dir,
     connect_1d const &conn_volumes, connect_1d const &conn_full,
-    std::vector<int> const &terms,
-    block_global_workspace<float> &workspace);
+    std::vector<int> const &terms, int coeff_bytes);
 
 template void global_cpu<float>(
     int, int, int64_t, vector2d<int> const &, dimension_sort const &,
@@ -1033,5 +1762,4 @@ template void globalsv_cpu(
     block_global_workspace<float> &workspace);
 #endif
 
-#endif // KRON_MODE_GLOBAL_BLOCK
 } // namespace asgard::kronmult
@@ -3,7 +3,6 @@
 
 namespace asgard::kronmult
 {
-#ifdef KRON_MODE_GLOBAL
 template<typename precision>
 void global_cpu_one(vector2d<int> const &ilist, dimension_sort const &dsort,
                     int dim, permutes::matrix_fill fill,
@@ -220,5 +219,4 @@ template void global_cpu(permutes const &perms,
                          float *, float *);
 #endif
 
-#endif
 } // namespace asgard::kronmult
@@ -3,7 +3,6 @@
 
 namespace asgard::kronmult
 {
-#ifdef KRON_MODE_GLOBAL
 #ifdef ASGARD_USE_CUDA
 
 template<typename precision>
@@ -94,6 +93,5 @@ template struct global_gpu_operations<double>;
 template struct global_gpu_operations<float>;
 #endif
 
-#endif
 #endif
 } // namespace asgard::kronmult
@@ -46,8 +46,6 @@ template void set_gpu_buffer_to_zero(int64_t, float *);
 } // namespace asgard::kronmult
 #endif
 
-#ifndef KRON_MODE_GLOBAL
-
 #ifdef ASGARD_USE_CUDA
 #include "asgard_kronmult_cycle1.hpp"
 #include "asgard_kronmult_cycle2.hpp"
@@ -605,5 +603,3 @@ template void gpu_dense<float>(int const, int const, int const, int64_t const,
 #endif
 
 } // namespace asgard::kronmult
-
-#endif // KMODE_GLOBAL
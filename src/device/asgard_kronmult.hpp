@@ -1,8 +1,11 @@
 #pragma once
 
 #include <algorithm>
+#include <deque>
 #include <iostream>
+#include <memory>
 #include <set>
+#include <type_traits>
 
 #include "asgard_indexset.hpp"
 #include "asgard_interpolation1d.hpp"
@@ -16,7 +19,6 @@ namespace asgard::kronmult
 template<typename T>
 void gpu_precon_jacobi(int64_t size, T dt, T const prec[], T x[]);
 
-#ifndef KRON_MODE_GLOBAL
 /*!
  * \internal
  * \brief (internal use only) Indicates how to interpret the alpha/beta scalars.
@@ -106,6 +108,57 @@ void cpu_sparse(int const dimensions, int const n, int const num_rows,
                 int const iA[], T const vA[], T const alpha, T const x[],
                 T const beta, T y[]);
 
+/*!
+ * \brief Sparse variant for the CPU using the packed index list.
+ *
+ * Same as cpu_sparse() but the indexes iA are stored in compressed form,
+ * which is valid only for the coefficients of the local kronmult matrix,
+ * i.e., vA holds rows of 1D blocks with block1d = dimensions * num_terms * n^2
+ * entries per 1D non-zero and each block holds the n by n matrices
+ * for all terms and dimensions, see asgard::local_kronmult_matrix.
+ * - the first num_rows * dimensions entries hold the offset of the start
+ *   of the 1D row of each tensor row and dimension, i.e.,
+ *   row_begin * block1d + d * n^2
+ * - the remaining entries hold the 16-bit local offsets of the 1D
+ *   non-zeros within the corresponding 1D rows, pntr[num_rows] * dimensions
+ *   offsets packed two per int with the even offsets in the lower bits
+ *
+ * The offsets for all terms are recovered by shifting with
+ * t * dimensions * n^2, thus the storage is about 2 * num_terms times
+ * smaller than the list used by cpu_sparse().
+ */
+template<typename T>
+void cpu_sparse_packed(int const dimensions, int const n, int const num_rows,
+                       int const pntr[], int const indx[],
+                       int const num_terms, int const iA[], T const vA[],
+                       T const alpha, T const x[], T const beta, T y[]);
+
+/*!
+ * \brief Combines the scalar products of the dense case with n = 1.
+ *
+ * For n = 1 each Kronecker product is a product of scalars and the sum
+ * over the terms forms an ordinary matrix. The inputs are the same as in
+ * cpu_dense() and M is the num_rows by num_cols matrix in column-major
+ * format, so that cpu_dense() is equivalent to lib_dispatch::gemv() with M.
+ */
+template<typename T>
+void cpu_n0_combine(int const dimensions, int const num_rows,
+                    int const num_cols, int const num_terms, int const elem[],
+                    int const row_offset, int const col_offset,
+                    T const *const vA[], int const num_1d_blocks, T M[]);
+
+/*!
+ * \brief Combines the scalar products of the sparse case with n = 1.
+ *
+ * Uses the full index list of cpu_sparse(), vals has one entry per
+ * (row, col) pair, so that pntr, indx and vals form a row-compressed
+ * matrix and cpu_sparse() is equivalent to lib_dispatch::sparse_gemv().
+ */
+template<typename T>
+void cpu_n0_combine(int const dimensions, int const num_rows, int const pntr[],
+                    int const num_terms, int const iA[], T const vA[],
+                    T vals[]);
+
 #ifdef ASGARD_USE_CUDA
 /*!
  * \brief Performs a batch of kronmult operations using a dense GPU matrix.
@@ -139,9 +192,7 @@ void gpu_sparse(int const dimensions, int const n, int const output_size,
                 int const num_terms, int const iA[], T const vA[],
                 T const alpha, T const x[], T const beta, T y[]);
 #endif
-#endif
 
-#ifdef KRON_MODE_GLOBAL
 /*!
   * \brief Compute the permutations (upper/lower) for global kronecker operations
   *
@@ -414,37 +465,328 @@ private:
 // Block Global Section, work directly with the index set
 // reduces the precomputed indexes and memory footprint
 
-#ifdef KRON_MODE_GLOBAL_BLOCK
+/*!
+ * \brief Instruction sets with dedicated block-global kernels.
+ *
+ * The kernels are compiled for all instruction sets and the best one
+ * supported by the cpu is selected at runtime, so the same binary works
+ * across different cpus without -march=native.
+ * The order matters, each set is a superset of the previous ones.
+ */
+enum class simd_isa
+{
+  //! \brief Generic code, vectorized only by the compiler flags.
+  scalar,
+  //! \brief Uses 256-bit AVX2 and FMA instructions.
+  avx2,
+  //! \brief Uses 512-bit AVX-512 instructions.
+  avx512
+};
+
+//! \brief Returns the best instruction set supported by the cpu.
+simd_isa detected_simd_isa();
+//! \brief Returns the instruction set used by the block-global kernels.
+simd_isa get_simd_isa();
+//! \brief Overrides the instruction set, throws if the cpu does not support it.
+void set_simd_isa(simd_isa isa);
+
+/*!
+ * \brief Allocator that skips the value initialization of new entries.
+ *
+ * The std::vector::resize() writes the new entries from the calling thread,
+ * which places all memory pages on the NUMA node of that thread.
+ * With this allocator, the pages are placed by the first parallel write.
+ */
+template<typename T>
+struct default_init_allocator : public std::allocator<T>
+{
+  template<typename U>
+  struct rebind
+  {
+    using other = default_init_allocator<U>;
+  };
+
+  default_init_allocator() noexcept = default;
+  template<typename U>
+  default_init_allocator(default_init_allocator<U> const &) noexcept
+  {}
+
+  template<typename U>
+  void construct(U *p) noexcept(std::is_nothrow_default_constructible_v<U>)
+  {
+    ::new (static_cast<void *>(p)) U;
+  }
+  template<typename U, typename... Args>
+  void construct(U *p, Args &&...args)
+  {
+    ::new (static_cast<void *>(p)) U(std::forward<Args>(args)...);
+  }
+};
+
+//! \brief Vector for the large workspaces, see first_touch_resize()
+template<typename T>
+using first_touch_vector = std::vector<T, default_init_allocator<T>>;
+
+/*!
+ * \brief Grows the vector to at least size entries, the content is not preserved.
+ *
+ * The entries are set to zero in parallel with a static partition of the range,
+ * i.e., the memory pages are placed on the NUMA nodes of the threads that
+ * work on the same range in the element-wise loops over the workspace.
+ */
+template<typename T>
+void first_touch_resize(first_touch_vector<T> &w, int64_t size)
+{
+  if (static_cast<int64_t>(w.size()) >= size)
+    return;
+  first_touch_vector<T>().swap(w); // release the old pages first
+  w.resize(size);
+  T *data = w.data();
+#pragma omp parallel for schedule(static)
+  for (int64_t i = 0; i < size; i++)
+    data[i] = T{0};
+}
+
+/*!
+ * \brief Precomputed connectivity for the 1d sweep over a list of cells.
+ *
+ * The plan is built once per grid for a direction, fill and 1d pattern.
+ * For each cell, the plan holds the connected cells present in the list
+ * and the index of the corresponding 1d coefficient block,
+ * so the sweep streams through the plan without resolving indexes.
+ * The rows follow the order of the dimension_sort.
+ */
+struct sweep_plan
+{
+  //! \brief Builds the plan for the given direction, fill and pattern.
+  sweep_plan(vector2d<int> const &ilist, dimension_sort const &dsort, int dim,
+             permutes::matrix_fill fill, connect_1d const &conn);
+
+  //! \brief Returns true if the plan was built for the given parameters.
+  bool matches(vector2d<int> const &ilist, int d, permutes::matrix_fill f,
+               connect_1d const &c) const
+  {
+    return (dim == d and fill == f and conn == &c and cells == ilist[0]
+            and num_cells == ilist.num_strips());
+  }
+
+  //! \brief Number of column blocks in the plan.
+  int64_t num_connections() const { return pntr.back(); }
+
+  /*!
+   * \brief Returns the rows [begin, end) of thread tid out of num_threads.
+   *
+   * The cost of a row is one for the initialization plus one per column block,
+   * the rows are split so that all threads get about the same total cost.
+   * If whole_vecs is set, the split does not break the vectors of the
+   * dimension_sort, e.g., for the triangular solves.
+   */
+  std::array<int, 2> split(int tid, int num_threads, bool whole_vecs) const;
+
+  int dim;
+  permutes::matrix_fill fill;
+  connect_1d const *conn;
+  //! \brief Identifies the list of cells, the plan is invalid if the list changes.
+  int const *cells;
+  int64_t num_cells;
+
+  //! \brief The cell of each row.
+  std::vector<int> rows;
+  //! \brief The row of each cell, i.e., the inverse of rows.
+  std::vector<int> index;
+  //! \brief The columns of row r are in the range pntr[r] to pntr[r + 1].
+  std::vector<int64_t> pntr;
+  //! \brief The connected cells for each row.
+  std::vector<int> cols;
+  //! \brief The index of the 1d coefficient block of each column.
+  std::vector<int> coeffs;
+  //! \brief The first row of each vector of the dimension_sort, the last entry is num_cells.
+  std::vector<int> vecs;
+};
 
 template<typename precision>
 struct block_global_workspace
 {
   std::vector<precision> x, y;
-  std::vector<precision> w1, w2;
-  std::vector<std::vector<int64_t>> row_map;
+  //! \brief Scratch space for the sweeps, placed with first_touch_resize()
+  first_touch_vector<precision> w1, w2;
+  //! \brief Interleaved input and output for the multi-vector apply.
+  first_touch_vector<precision> xrhs, yrhs;
+  //! \brief Cached sweep plans, must be cleared when the grid changes.
+  std::deque<sweep_plan> plans;
+  //! \brief Thread-local buffers for the tiled (fused) sweeps.
+  std::vector<std::vector<precision>> tile_map;
 };
 
-// block-size = n^num_dimensions but saves work recomputing
-template<typename precision>
+/*!
+ * \brief Groups the cells into tiles closed under the 1d sweeps in several directions.
+ *
+ * The 1d sweep in direction d couples only cells that share the indexes
+ * in all other directions. Given a set of directions S, all cells that share
+ * the indexes outside of S form a tile and the sweeps in all directions of S
+ * never couple cells across tiles. Thus, all directions of S can be applied
+ * tile-by-tile, where the intermediate results of a tile stay in cache,
+ * as opposed to streaming the full workspace vectors once per direction.
+ *
+ * The tile sets are constructed for the leading directions of each
+ * permutation, using the largest leading set that still gives enough tiles
+ * for the threads and a tile footprint that fits in the given cache budget.
+ */
+struct sweep_tiles
+{
+  //! \brief Default cache budget for the intermediate data of a tile.
+  static constexpr int64_t default_cache_bytes = 1048576;
+
+  //! \brief Tiles closed under the sweeps in the directions of the mask.
+  struct tile_set
+  {
+    //! \brief Bit-mask of the directions fused within the tiles.
+    int mask = 0;
+    //! \brief Tiles with up to that many cells use the thread-local buffers.
+    int cache_cells = 0;
+    //! \brief Begin/end offsets of the tiles in the tile ordering.
+    std::vector<int> tpntr;
+    //! \brief Local index of each cell within its tile.
+    std::vector<int> local;
+    //! \brief For each direction in the mask, the cells sorted into 1d lines.
+    std::array<std::vector<int>, max_num_dimensions> lcells;
+    //! \brief Begin/end offsets of the lines within lcells.
+    std::array<std::vector<int>, max_num_dimensions> lpntr;
+    //! \brief Begin/end offsets of the lines of each tile.
+    std::array<std::vector<int>, max_num_dimensions> tlines;
+
+    //! \brief Number of tiles in the set.
+    int num_tiles() const { return static_cast<int>(tpntr.size()) - 1; }
+    //! \brief Number of cells in the tile.
+    int tile_size(int t) const { return tpntr[t + 1] - tpntr[t]; }
+  };
+
+  //! \brief No tiles, all sweeps are performed one direction at a time.
+  sweep_tiles() = default;
+  /*!
+   * \brief Constructs the tiles for the permutations of all terms.
+   *
+   * \param ilist is the list of cells
+   * \param perms is the list of permutations for all terms
+   * \param block_bytes is the size of the data for a single cell
+   * \param cache_bytes is the cache budget for the intermediate results of a tile
+   * \param min_tiles is the minimum number of tiles that keeps the threads busy,
+   *        if negative, a multiple of the max number of OpenMP threads is used
+   */
+  sweep_tiles(vector2d<int> const &ilist, std::vector<permutes> const &perms,
+              int64_t block_bytes, int64_t cache_bytes = default_cache_bytes,
+              int min_tiles = -1);
+
+  /*!
+   * \brief Finds the tiles for the leading directions of the given permutation
+   *
+   * Returns nullptr if no tiles can be used for the permutation,
+   * otherwise the number of fused leading directions is written in num_fused.
+   */
+  tile_set const *find(std::vector<int> const &direction, int &num_fused) const
+  {
+    int const num_dirs = static_cast<int>(direction.size());
+    for (int p = num_dirs; p > 1; p--)
+    {
+      int const mask = direction_mask(direction, p);
+      for (auto const &tset : sets_)
+        if (tset.mask == mask)
+        {
+          num_fused = p;
+          return &tset;
+        }
+    }
+    return nullptr;
+  }
+
+  //! \brief Returns true if there are no tiles.
+  bool empty() const { return sets_.empty(); }
+
+  //! \brief Returns the bit-mask for the first num_fused directions.
+  static int direction_mask(std::vector<int> const &direction, int num_fused)
+  {
+    int mask = 0;
+    for (int d = 0; d < num_fused; d++)
+      mask |= (1 << direction[d]);
+    return mask;
+  }
+
+private:
+  std::vector<tile_set> sets_;
+};
+
+/*!
+ * \brief Applies the terms to x and adds the result to y.
+ *
+ * The block-size is n^num_dimensions but saves work recomputing.
+ * The coefficients gvals can be stored in lower precision (cprecision),
+ * e.g., float with double x and y, the products are accumulated in precision.
+ */
+template<typename precision, typename cprecision>
 void global_cpu(int num_dimensions, int n, int64_t block_size,
                 vector2d<int> const &ilist, dimension_sort const &dsort,
                 std::vector<permutes> const &perms,
                 std::vector<int> const &flux_dir,
                 connect_1d const &conn_volumes, connect_1d const &conn_full,
-                std::vector<std::vector<precision>> const &gvals,
-                std::vector<int> const &terms,
+                std::vector<std::vector<cprecision>> const &gvals,
+                std::vector<int> const &terms, sweep_tiles const &tiles,
                 precision const x[], precision y[],
                 block_global_workspace<precision> &workspace);
 
+/*!
+ * \brief Applies the terms to num_rhs vectors at once.
+ *
+ * The vectors are interleaved, i.e., entry i of vector v is at
+ * x[i * num_rhs + v], the same holds for y.
+ * The 1d coefficients and the connectivity are loaded once for all vectors.
+ */
+template<typename precision, typename cprecision>
+void global_cpu(int num_dimensions, int n, int64_t block_size,
+                vector2d<int> const &ilist, dimension_sort const &dsort,
+                std::vector<permutes> const &perms,
+                std::vector<int> const &flux_dir,
+                connect_1d const &conn_volumes, connect_1d const &conn_full,
+                std::vector<std::vector<cprecision>> const &gvals,
+                std::vector<int> const &terms, int num_rhs,
+                precision const x[], precision y[],
+                block_global_workspace<precision> &workspace);
+
+/*!
+ * \brief Roofline data for one application of the block-global kronmult.
+ *
+ * The bytes are an estimate of the main memory traffic, assuming that
+ * each sweep streams the input and output vectors and the index data once
+ * and the 1d coefficients are loaded once per sweep.
+ */
+struct kron_roofline
+{
+  //! \brief Number of floating point operations.
+  int64_t flops = 0;
+  //! \brief Estimated number of bytes moved to and from memory.
+  int64_t bytes = 0;
+  //! \brief Returns the arithmetic intensity, i.e., flops per byte.
+  double intensity() const
+  {
+    return (bytes > 0) ? static_cast<double>(flops) / static_cast<double>(bytes) : 0.0;
+  }
+};
+
+/*!
+ * \brief Computes the flops and the memory traffic of the terms.
+ *
+ * The connected blocks are counted directly from the 1d connectivity
+ * and the dimension sort, no sweep plans are built and no kernels are called.
+ * The coeff_bytes is the size of one 1d coefficient, e.g., sizeof(float)
+ * when using single precision coefficients.
+ */
 template<typename precision>
-int64_t block_global_count_flops(
-    int num_dimensions, int64_t block_size,
+kron_roofline block_global_roofline(
+    int num_dimensions, int n, int64_t block_size,
     vector2d<int> const &ilist, dimension_sort const &dsort,
     std::vector<permutes> const &perms,
     std::vector<int> const &flux_dir,
     connect_1d const &conn_volumes, connect_1d const &conn_full,
-    std::vector<int> const &terms,
-    block_global_workspace<precision> &workspace);
+    std::vector<int> const &terms, int coeff_bytes);
 
 template<typename precision>
 void global_cpu(int num_dimensions, int n, int64_t block_size,
@@ -466,7 +808,4 @@ void globalsv_cpu(int num_dimensions, int n, vector2d<int> const &ilist,
                   precision const gvals[], precision y[],
                   block_global_workspace<precision> &workspace);
 
-#endif
-#endif
-
 } // namespace asgard::kronmult
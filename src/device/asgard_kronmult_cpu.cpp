@@ -5,8 +5,6 @@
 
 #include "asgard_kronmult.hpp"
 
-#ifndef KRON_MODE_GLOBAL
-
 #include "asgard_kronmult_cpu_general.hpp"
 
 namespace asgard::kronmult
@@ -20,8 +18,8 @@ namespace asgard::kronmult
  * Nevertheless, this implementation is provided for completeness,
  * where the case n=1 is handled in the same data structures as n>1.
  *
- * TODO: can fix that in the kronmult_matrix factory and switch to dense
- *       matrix-matrix implementation.
+ * The local_kronmult_matrix uses cpu_n0_combine() and gemv/gemm instead,
+ * this kernel is the fallback.
  */
 template<typename P, scalar_case alpha_case, scalar_case beta_case>
 void cpu_n0(int const dimensions, int const num_rows, int const num_cols,
@@ -818,14 +816,51 @@ void cpu_dense(int const dimensions, int const n, int const num_rows,
   }
 }
 
+template<typename P>
+void cpu_n0_combine(int const dimensions, int const num_rows,
+                    int const num_cols, int const num_terms, int const elem[],
+                    int const row_offset, int const col_offset,
+                    P const *const vA[], int const num_1d_blocks, P M[])
+{
+  int const vstride = num_1d_blocks * num_1d_blocks;
+#pragma omp parallel for
+  for (int colx = 0; colx < num_cols; colx++)
+  {
+    int const *ix = elem + (colx + col_offset) * dimensions;
+    P *const mcol = M + int64_t{colx} * num_rows;
+
+    for (int rowy = 0; rowy < num_rows; rowy++)
+    {
+      int const *iy = elem + (rowy + row_offset) * dimensions;
+
+      P sum = 0;
+      for (int t = 0; t < num_terms; t++)
+      {
+        P totalA = 1;
+        for (int d = 0; d < dimensions; d++)
+          totalA *= vA[t][d * vstride + ix[d] * num_1d_blocks + iy[d]];
+        sum += totalA;
+      }
+      mcol[rowy] = sum;
+    }
+  }
+}
+
 #ifndef ASGARD_USE_CUDA // no need to compile for the CPU if CUDA is on
 #ifdef ASGARD_ENABLE_DOUBLE
+template void cpu_n0_combine<double>(int const, int const, int const,
+                                     int const, int const[], int const,
+                                     int const, double const *const[],
+                                     int const, double[]);
 template void cpu_dense<double>(int const, int const, int const, int const,
                                 int const, int const[], int const, int const,
                                 double const *const[], int const, double const,
                                 double const[], double const, double y[]);
 #endif
 #ifdef ASGARD_ENABLE_FLOAT
+template void cpu_n0_combine<float>(int const, int const, int const, int const,
+                                    int const[], int const, int const,
+                                    float const *const[], int const, float[]);
 template void cpu_dense<float>(int const, int const, int const, int const,
                                int const, int const[], int const, int const,
                                float const *const[], int const, float const,
@@ -834,5 +869,3 @@ template void cpu_dense<float>(int const, int const, int const, int const,
 #endif
 
 } // namespace asgard::kronmult
-
-#endif // KRON_MODE_GLOBAL
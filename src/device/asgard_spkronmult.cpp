@@ -5,8 +5,6 @@
 
 #include "asgard_kronmult.hpp"
 
-#ifndef KRON_MODE_GLOBAL
-
 #ifdef ASGARD_USE_CUDA
 #include "asgard_spkronmult_cycle1.hpp"
 #include "asgard_spkronmult_cycle2.hpp"
@@ -485,5 +483,3 @@ template void gpu_sparse<float>(int const, int const, int const, int const,
 #endif
 
 } // namespace asgard::kronmult
-
-#endif // KRON_MODE_GLOBAL
@@ -5,8 +5,6 @@
 
 #include "asgard_kronmult.hpp"
 
-#ifndef KRON_MODE_GLOBAL
-
 #include "asgard_spkronmult_cpu_general.hpp"
 
 namespace asgard::kronmult
@@ -20,43 +18,50 @@ namespace asgard::kronmult
  * Nevertheless, this implementation is provided for completeness,
  * where the case n=1 is handled in the same data structures as n>1.
  *
- * TODO: can fix that in the kronmult_matrix factory and switch to dense
- *       matrix-matrix implementation.
+ * The local_kronmult_matrix uses cpu_n0_combine() and a sparse matrix-vector
+ * product instead, this kernel is the fallback.
  */
-template<typename T, scalar_case alpha_case, scalar_case beta_case>
+template<typename T, scalar_case alpha_case, scalar_case beta_case,
+         typename index_list>
 void cpu_n0(int const dimensions, int const num_rows, int const pntr[],
-            int const indx[], int const num_terms, int const iA[], T const vA[],
-            T const alpha, T const x[], T const beta, T y[])
+            int const indx[], int const num_terms, index_list const &iA,
+            T const vA[], T const alpha, T const x[], T const beta, T y[])
 {
   (void)alpha;
   (void)beta;
-#pragma omp parallel for
-  for (int iy = 0; iy < num_rows; iy++)
+#pragma omp parallel
   {
-    if constexpr (beta_case == scalar_case::zero)
-      y[iy] = 0;
-    else if constexpr (beta_case == scalar_case::neg_one)
-      y[iy] = -y[iy];
-    else if constexpr (beta_case == scalar_case::other)
-      y[iy] *= beta;
-
-    // ma is the starting index of the operators for this y
-    int ma = pntr[iy] * num_terms * dimensions;
+    std::vector<int> scratch(iA.scratch_size());
 
-    for (int jx = pntr[iy]; jx < pntr[iy + 1]; jx++)
+#pragma omp for
+    for (int iy = 0; iy < num_rows; iy++)
     {
-      for (int t = 0; t < num_terms; t++)
+      if constexpr (beta_case == scalar_case::zero)
+        y[iy] = 0;
+      else if constexpr (beta_case == scalar_case::neg_one)
+        y[iy] = -y[iy];
+      else if constexpr (beta_case == scalar_case::other)
+        y[iy] *= beta;
+
+      for (int jx = pntr[iy]; jx < pntr[iy + 1]; jx++)
       {
-        T totalA = 1;
-        for (int d = 0; d < dimensions; d++)
-          totalA *= vA[iA[ma++]];
+        // the operator indexes for this (row, col) pair
+        int const *const pA = iA(iy, jx, scratch.data());
+        int ma = 0;
+
+        for (int t = 0; t < num_terms; t++)
+        {
+          T totalA = 1;
+          for (int d = 0; d < dimensions; d++)
+            totalA *= vA[pA[ma++]];
 
-        if constexpr (alpha_case == scalar_case::one)
-          y[iy] += totalA * x[indx[jx]];
-        else if constexpr (alpha_case == scalar_case::neg_one)
-          y[iy] -= totalA * x[indx[jx]];
-        else
-          y[iy] += alpha * totalA * x[indx[jx]];
+          if constexpr (alpha_case == scalar_case::one)
+            y[iy] += totalA * x[indx[jx]];
+          else if constexpr (alpha_case == scalar_case::neg_one)
+            y[iy] -= totalA * x[indx[jx]];
+          else
+            y[iy] += alpha * totalA * x[indx[jx]];
+        }
       }
     }
   }
@@ -80,11 +85,12 @@ void cpu_n0(int const dimensions, int const num_rows, int const pntr[],
  *         no multiplication
  * \tparam beta_case must match beta, one for beta = 1, neg_one for beta = -1,
  *         zero for beta = 0 and other in all other cases
+ * \tparam index_list is either full_index_list or packed_index_list
  */
 template<typename T, int dimensions, int n, scalar_case alpha_case,
-         scalar_case beta_case>
+         scalar_case beta_case, typename index_list>
 void cpu_sparse(int const num_rows, int const pntr[], int const indx[],
-                int const num_terms, int const iA[], T const vA[],
+                int const num_terms, index_list const &iA, T const vA[],
                 T const alpha, T const x[], T const beta, T y[])
 {
   static_assert(1 <= dimensions and dimensions <= 6);
@@ -92,350 +98,357 @@ void cpu_sparse(int const num_rows, int const pntr[], int const indx[],
                        "by another method");
   (void)alpha;
   (void)beta;
-// always use one thread per kron-product
-#pragma omp parallel for
-  for (int iy = 0; iy < num_rows; iy++)
+#pragma omp parallel
   {
-    // tensor i (ti) is the first index of this tensor in y
-    int const ti = iy * ipow<n, dimensions>();
-    if constexpr (beta_case == scalar_case::zero)
-      for (int j = 0; j < ipow<n, dimensions>(); j++)
-        y[ti + j] = 0;
-    else if constexpr (beta_case == scalar_case::neg_one)
-      for (int j = 0; j < ipow<n, dimensions>(); j++)
-        y[ti + j] = -y[ti + j];
-    else if constexpr (beta_case == scalar_case::other)
-      for (int j = 0; j < ipow<n, dimensions>(); j++)
-        y[ti + j] *= beta;
-
-    // ma is the starting index of the operators for this y
-    int ma = pntr[iy] * num_terms * dimensions;
+    std::vector<int> scratch(iA.scratch_size());
 
-    for (int jx = pntr[iy]; jx < pntr[iy + 1]; jx++)
+// always use one thread per kron-product
+#pragma omp for
+    for (int iy = 0; iy < num_rows; iy++)
     {
-      // tensor i (ti) is the first index of this tensor in x
-      int const tj = indx[jx] * ipow<n, dimensions>();
-      for (int t = 0; t < num_terms; t++)
+      // tensor i (ti) is the first index of this tensor in y
+      int const ti = iy * ipow<n, dimensions>();
+      if constexpr (beta_case == scalar_case::zero)
+        for (int j = 0; j < ipow<n, dimensions>(); j++)
+          y[ti + j] = 0;
+      else if constexpr (beta_case == scalar_case::neg_one)
+        for (int j = 0; j < ipow<n, dimensions>(); j++)
+          y[ti + j] = -y[ti + j];
+      else if constexpr (beta_case == scalar_case::other)
+        for (int j = 0; j < ipow<n, dimensions>(); j++)
+          y[ti + j] *= beta;
+
+      for (int jx = pntr[iy]; jx < pntr[iy + 1]; jx++)
       {
-        if constexpr (dimensions == 1)
-        {
-          T const *const A = &(vA[iA[ma++]]);
-          T Y[n]           = {{0}};
-          ASGARD_PRAGMA_OMP_SIMD(collapse(2))
-          for (int j = 0; j < n; j++)
-            for (int k = 0; k < n; k++)
-              Y[k] += A[j * n + k] * x[tj + j];
+        // the operator indexes for this (row, col) pair
+        int const *const pA = iA(iy, jx, scratch.data());
+        int ma = 0;
 
-          ASGARD_PRAGMA_OMP_SIMD()
-          for (int j = 0; j < n; j++)
-            if constexpr (alpha_case == scalar_case::one)
-              y[ti + j] += Y[j];
-            else if constexpr (alpha_case == scalar_case::neg_one)
-              y[ti + j] -= Y[j];
-            else
-              y[ti + j] += alpha * Y[j];
-        }
-        else if constexpr (dimensions == 2)
+        // tensor i (ti) is the first index of this tensor in x
+        int const tj = indx[jx] * ipow<n, dimensions>();
+        for (int t = 0; t < num_terms; t++)
         {
-          T const *A = &(vA[iA[ma++]]); // A1
-          T W[n][n] = {{{0}}}, Y[n][n] = {{{0}}};
-          ASGARD_PRAGMA_OMP_SIMD(collapse(3))
-          for (int j = 0; j < n; j++)
-            for (int s = 0; s < n; s++)
+          if constexpr (dimensions == 1)
+          {
+            T const *const A = &(vA[pA[ma++]]);
+            T Y[n]           = {{0}};
+            ASGARD_PRAGMA_OMP_SIMD(collapse(2))
+            for (int j = 0; j < n; j++)
               for (int k = 0; k < n; k++)
-                W[s][k] += x[tj + n * j + k] * A[j * n + s];
-          A = &(vA[iA[ma++]]); // A0
-          ASGARD_PRAGMA_OMP_SIMD(collapse(3))
-          for (int k = 0; k < n; k++)
+                Y[k] += A[j * n + k] * x[tj + j];
+
+            ASGARD_PRAGMA_OMP_SIMD()
             for (int j = 0; j < n; j++)
-              for (int s = 0; s < n; s++)
-                Y[k][s] += A[j * n + s] * W[k][j];
-          ASGARD_PRAGMA_OMP_SIMD(collapse(2))
-          for (int j = 0; j < n; j++)
-            for (int k = 0; k < n; k++)
               if constexpr (alpha_case == scalar_case::one)
-                y[ti + n * j + k] += Y[j][k];
+                y[ti + j] += Y[j];
               else if constexpr (alpha_case == scalar_case::neg_one)
-                y[ti + n * j + k] -= Y[j][k];
+                y[ti + j] -= Y[j];
               else
-                y[ti + n * j + k] += alpha * Y[j][k];
-        }
-        else if constexpr (dimensions == 3)
-        {
-          T const *A   = &(vA[iA[ma++]]); // A2
-          T W[n][n][n] = {{{{0}}}}, Y[n][n][n] = {{{{0}}}};
-          ASGARD_PRAGMA_OMP_SIMD(collapse(4))
-          for (int j = 0; j < n; j++)
-            for (int s = 0; s < n; s++)
-              for (int l = 0; l < n; l++)
-                for (int k = 0; k < n; k++)
-                  Y[s][l][k] += x[tj + n * n * j + n * l + k] * A[j * n + s];
-          A = &(vA[iA[ma++]]); // A1
-          ASGARD_PRAGMA_OMP_SIMD(collapse(4))
-          for (int l = 0; l < n; l++)
+                y[ti + j] += alpha * Y[j];
+          }
+          else if constexpr (dimensions == 2)
+          {
+            T const *A = &(vA[pA[ma++]]); // A1
+            T W[n][n] = {{{0}}}, Y[n][n] = {{{0}}};
+            ASGARD_PRAGMA_OMP_SIMD(collapse(3))
             for (int j = 0; j < n; j++)
               for (int s = 0; s < n; s++)
                 for (int k = 0; k < n; k++)
-                  W[l][s][k] += Y[l][j][k] * A[j * n + s];
-          std::fill(&Y[0][0][0], &Y[0][0][0] + sizeof(W) / sizeof(T), T{0.});
-          A = &(vA[iA[ma++]]); // A0
-          ASGARD_PRAGMA_OMP_SIMD(collapse(4))
-          for (int l = 0; l < n; l++)
+                  W[s][k] += x[tj + n * j + k] * A[j * n + s];
+            A = &(vA[pA[ma++]]); // A0
+            ASGARD_PRAGMA_OMP_SIMD(collapse(3))
             for (int k = 0; k < n; k++)
               for (int j = 0; j < n; j++)
                 for (int s = 0; s < n; s++)
-                  Y[l][k][s] += A[j * n + s] * W[l][k][j];
-          ASGARD_PRAGMA_OMP_SIMD(collapse(3))
-          for (int j = 0; j < n; j++)
-            for (int l = 0; l < n; l++)
+                  Y[k][s] += A[j * n + s] * W[k][j];
+            ASGARD_PRAGMA_OMP_SIMD(collapse(2))
+            for (int j = 0; j < n; j++)
               for (int k = 0; k < n; k++)
                 if constexpr (alpha_case == scalar_case::one)
-                  y[ti + n * n * j + n * l + k] += Y[j][l][k];
+                  y[ti + n * j + k] += Y[j][k];
                 else if constexpr (alpha_case == scalar_case::neg_one)
-                  y[ti + n * n * j + n * l + k] -= Y[j][l][k];
+                  y[ti + n * j + k] -= Y[j][k];
                 else
-                  y[ti + n * n * j + n * l + k] += alpha * Y[j][l][k];
-        }
-        else if constexpr (dimensions == 4)
-        {
-          T W[n][n][n][n] = {{{{{0}}}}}, Y[n][n][n][n] = {{{{{0}}}}};
-          T const *A = &(vA[iA[ma++]]); // A3
-          ASGARD_PRAGMA_OMP_SIMD(collapse(5))
-          for (int j = 0; j < n; j++)
-            for (int s = 0; s < n; s++)
-              for (int p = 0; p < n; p++)
-                for (int l = 0; l < n; l++)
-                  for (int k = 0; k < n; k++)
-                    W[s][p][l][k] +=
-                        x[tj + n * n * n * j + n * n * p + n * l + k] *
-                        A[j * n + s];
-          A = &(vA[iA[ma++]]); // A2
-          ASGARD_PRAGMA_OMP_SIMD(collapse(5))
-          for (int p = 0; p < n; p++)
+                  y[ti + n * j + k] += alpha * Y[j][k];
+          }
+          else if constexpr (dimensions == 3)
+          {
+            T const *A   = &(vA[pA[ma++]]); // A2
+            T W[n][n][n] = {{{{0}}}}, Y[n][n][n] = {{{{0}}}};
+            ASGARD_PRAGMA_OMP_SIMD(collapse(4))
             for (int j = 0; j < n; j++)
               for (int s = 0; s < n; s++)
                 for (int l = 0; l < n; l++)
                   for (int k = 0; k < n; k++)
-                    Y[p][s][l][k] += W[p][j][l][k] * A[j * n + s];
-          std::fill(&W[0][0][0][0], &W[0][0][0][0] + sizeof(W) / sizeof(T),
-                    T{0.});
-          A = &(vA[iA[ma++]]); // A1
-          ASGARD_PRAGMA_OMP_SIMD(collapse(5))
-          for (int p = 0; p < n; p++)
+                    Y[s][l][k] += x[tj + n * n * j + n * l + k] * A[j * n + s];
+            A = &(vA[pA[ma++]]); // A1
+            ASGARD_PRAGMA_OMP_SIMD(collapse(4))
             for (int l = 0; l < n; l++)
               for (int j = 0; j < n; j++)
                 for (int s = 0; s < n; s++)
                   for (int k = 0; k < n; k++)
-                    W[p][l][s][k] += Y[p][l][j][k] * A[j * n + s];
-          std::fill(&Y[0][0][0][0], &Y[0][0][0][0] + sizeof(W) / sizeof(T),
-                    T{0.});
-          A = &(vA[iA[ma++]]); // A0
-          ASGARD_PRAGMA_OMP_SIMD(collapse(5))
-          for (int p = 0; p < n; p++)
+                    W[l][s][k] += Y[l][j][k] * A[j * n + s];
+            std::fill(&Y[0][0][0], &Y[0][0][0] + sizeof(W) / sizeof(T), T{0.});
+            A = &(vA[pA[ma++]]); // A0
+            ASGARD_PRAGMA_OMP_SIMD(collapse(4))
             for (int l = 0; l < n; l++)
               for (int k = 0; k < n; k++)
                 for (int j = 0; j < n; j++)
                   for (int s = 0; s < n; s++)
-                    Y[p][l][k][s] += A[j * n + s] * W[p][l][k][j];
-          ASGARD_PRAGMA_OMP_SIMD(collapse(4))
-          for (int j = 0; j < n; j++)
-            for (int p = 0; p < n; p++)
+                    Y[l][k][s] += A[j * n + s] * W[l][k][j];
+            ASGARD_PRAGMA_OMP_SIMD(collapse(3))
+            for (int j = 0; j < n; j++)
               for (int l = 0; l < n; l++)
                 for (int k = 0; k < n; k++)
                   if constexpr (alpha_case == scalar_case::one)
-                    y[ti + n * n * n * j + n * n * p + n * l + k] +=
-                        Y[j][p][l][k];
+                    y[ti + n * n * j + n * l + k] += Y[j][l][k];
                   else if constexpr (alpha_case == scalar_case::neg_one)
-                    y[ti + n * n * n * j + n * n * p + n * l + k] -=
-                        Y[j][p][l][k];
+                    y[ti + n * n * j + n * l + k] -= Y[j][l][k];
                   else
-                    y[ti + n * n * n * j + n * n * p + n * l + k] +=
-                        alpha * Y[j][p][l][k];
-        }
-        else if constexpr (dimensions == 5)
-        {
-          T W[n][n][n][n][n] = {{{{{{0}}}}}}, Y[n][n][n][n][n] = {{{{{{0}}}}}};
-          T const *A = &(vA[iA[ma++]]); // A4
-          ASGARD_PRAGMA_OMP_SIMD(collapse(6))
-          for (int j = 0; j < n; j++)
-            for (int s = 0; s < n; s++)
-              for (int v = 0; v < n; v++)
-                for (int p = 0; p < n; p++)
-                  for (int l = 0; l < n; l++)
-                    for (int k = 0; k < n; k++)
-                      Y[s][v][p][l][k] +=
-                          x[tj + n * n * n * n * j + n * n * n * v + n * n * p +
-                            n * l + k] *
-                          A[j * n + s];
-          A = &(vA[iA[ma++]]); // A3
-          ASGARD_PRAGMA_OMP_SIMD(collapse(6))
-          for (int v = 0; v < n; v++)
+                    y[ti + n * n * j + n * l + k] += alpha * Y[j][l][k];
+          }
+          else if constexpr (dimensions == 4)
+          {
+            T W[n][n][n][n] = {{{{{0}}}}}, Y[n][n][n][n] = {{{{{0}}}}};
+            T const *A = &(vA[pA[ma++]]); // A3
+            ASGARD_PRAGMA_OMP_SIMD(collapse(5))
             for (int j = 0; j < n; j++)
               for (int s = 0; s < n; s++)
                 for (int p = 0; p < n; p++)
                   for (int l = 0; l < n; l++)
                     for (int k = 0; k < n; k++)
-                      W[v][s][p][l][k] += Y[v][j][p][l][k] * A[j * n + s];
-          std::fill(&Y[0][0][0][0][0],
-                    &Y[0][0][0][0][0] + sizeof(W) / sizeof(T), T{0.});
-          A = &(vA[iA[ma++]]); // A2
-          ASGARD_PRAGMA_OMP_SIMD(collapse(6))
-          for (int v = 0; v < n; v++)
+                      W[s][p][l][k] +=
+                          x[tj + n * n * n * j + n * n * p + n * l + k] *
+                          A[j * n + s];
+            A = &(vA[pA[ma++]]); // A2
+            ASGARD_PRAGMA_OMP_SIMD(collapse(5))
             for (int p = 0; p < n; p++)
               for (int j = 0; j < n; j++)
                 for (int s = 0; s < n; s++)
                   for (int l = 0; l < n; l++)
                     for (int k = 0; k < n; k++)
-                      Y[v][p][s][l][k] += W[v][p][j][l][k] * A[j * n + s];
-          std::fill(&W[0][0][0][0][0],
-                    &W[0][0][0][0][0] + sizeof(W) / sizeof(T), T{0.});
-          A = &(vA[iA[ma++]]); // A1
-          ASGARD_PRAGMA_OMP_SIMD(collapse(6))
-          for (int v = 0; v < n; v++)
+                      Y[p][s][l][k] += W[p][j][l][k] * A[j * n + s];
+            std::fill(&W[0][0][0][0], &W[0][0][0][0] + sizeof(W) / sizeof(T),
+                      T{0.});
+            A = &(vA[pA[ma++]]); // A1
+            ASGARD_PRAGMA_OMP_SIMD(collapse(5))
             for (int p = 0; p < n; p++)
               for (int l = 0; l < n; l++)
                 for (int j = 0; j < n; j++)
                   for (int s = 0; s < n; s++)
                     for (int k = 0; k < n; k++)
-                      W[v][p][l][s][k] += Y[v][p][l][j][k] * A[j * n + s];
-          std::fill(&Y[0][0][0][0][0],
-                    &Y[0][0][0][0][0] + sizeof(W) / sizeof(T), T{0.});
-          A = &(vA[iA[ma++]]); // A0
-          ASGARD_PRAGMA_OMP_SIMD(collapse(6))
-          for (int v = 0; v < n; v++)
+                      W[p][l][s][k] += Y[p][l][j][k] * A[j * n + s];
+            std::fill(&Y[0][0][0][0], &Y[0][0][0][0] + sizeof(W) / sizeof(T),
+                      T{0.});
+            A = &(vA[pA[ma++]]); // A0
+            ASGARD_PRAGMA_OMP_SIMD(collapse(5))
             for (int p = 0; p < n; p++)
               for (int l = 0; l < n; l++)
                 for (int k = 0; k < n; k++)
                   for (int j = 0; j < n; j++)
                     for (int s = 0; s < n; s++)
-                      Y[v][p][l][k][s] += A[j * n + s] * W[v][p][l][k][j];
-          ASGARD_PRAGMA_OMP_SIMD(collapse(5))
-          for (int j = 0; j < n; j++)
-            for (int v = 0; v < n; v++)
+                      Y[p][l][k][s] += A[j * n + s] * W[p][l][k][j];
+            ASGARD_PRAGMA_OMP_SIMD(collapse(4))
+            for (int j = 0; j < n; j++)
               for (int p = 0; p < n; p++)
                 for (int l = 0; l < n; l++)
                   for (int k = 0; k < n; k++)
                     if constexpr (alpha_case == scalar_case::one)
-                      y[ti + n * n * n * n * j + n * n * n * v + n * n * p +
-                        n * l + k] += Y[j][v][p][l][k];
+                      y[ti + n * n * n * j + n * n * p + n * l + k] +=
+                          Y[j][p][l][k];
                     else if constexpr (alpha_case == scalar_case::neg_one)
-                      y[ti + n * n * n * n * j + n * n * n * v + n * n * p +
-                        n * l + k] -= Y[j][v][p][l][k];
+                      y[ti + n * n * n * j + n * n * p + n * l + k] -=
+                          Y[j][p][l][k];
                     else
-                      y[ti + n * n * n * n * j + n * n * n * v + n * n * p +
-                        n * l + k] += alpha * Y[j][v][p][l][k];
-        }
-        else if constexpr (dimensions == 6)
-        {
-          T W[n][n][n][n][n][n] = {{{{{{{0}}}}}}},
-            Y[n][n][n][n][n][n] = {{{{{{{0}}}}}}};
-          T const *A            = &(vA[iA[ma++]]); // A5
-          ASGARD_PRAGMA_OMP_SIMD(collapse(7))
-          for (int j = 0; j < n; j++)
-            for (int s = 0; s < n; s++)
-              for (int w = 0; w < n; w++)
-                for (int v = 0; v < n; v++)
-                  for (int p = 0; p < n; p++)
-                    for (int l = 0; l < n; l++)
-                      for (int k = 0; k < n; k++)
-                        W[s][w][v][p][l][k] +=
-                            x[tj + n * n * n * n * n * j + n * n * n * n * w +
-                              n * n * n * v + n * n * p + n * l + k] *
-                            A[j * n + s];
-          A = &(vA[iA[ma++]]); // A4
-          ASGARD_PRAGMA_OMP_SIMD(collapse(7))
-          for (int w = 0; w < n; w++)
+                      y[ti + n * n * n * j + n * n * p + n * l + k] +=
+                          alpha * Y[j][p][l][k];
+          }
+          else if constexpr (dimensions == 5)
+          {
+            T W[n][n][n][n][n] = {{{{{{0}}}}}},
+              Y[n][n][n][n][n] = {{{{{{0}}}}}};
+            T const *A = &(vA[pA[ma++]]); // A4
+            ASGARD_PRAGMA_OMP_SIMD(collapse(6))
             for (int j = 0; j < n; j++)
               for (int s = 0; s < n; s++)
                 for (int v = 0; v < n; v++)
                   for (int p = 0; p < n; p++)
                     for (int l = 0; l < n; l++)
                       for (int k = 0; k < n; k++)
-                        Y[w][s][v][p][l][k] +=
-                            W[w][j][v][p][l][k] * A[j * n + s];
-          std::fill(&W[0][0][0][0][0][0],
-                    &W[0][0][0][0][0][0] + sizeof(W) / sizeof(T), T{0.});
-          A = &(vA[iA[ma++]]); // A3
-          for (int w = 0; w < n; w++)
+                        Y[s][v][p][l][k] +=
+                            x[tj + n * n * n * n * j + n * n * n * v +
+                              n * n * p + n * l + k] *
+                            A[j * n + s];
+            A = &(vA[pA[ma++]]); // A3
+            ASGARD_PRAGMA_OMP_SIMD(collapse(6))
             for (int v = 0; v < n; v++)
               for (int j = 0; j < n; j++)
                 for (int s = 0; s < n; s++)
                   for (int p = 0; p < n; p++)
                     for (int l = 0; l < n; l++)
                       for (int k = 0; k < n; k++)
-                        W[w][v][s][p][l][k] +=
-                            Y[w][v][j][p][l][k] * A[j * n + s];
-          std::fill(&Y[0][0][0][0][0][0],
-                    &Y[0][0][0][0][0][0] + sizeof(W) / sizeof(T), T{0.});
-          A = &(vA[iA[ma++]]); // A2
-          ASGARD_PRAGMA_OMP_SIMD(collapse(7))
-          for (int w = 0; w < n; w++)
+                        W[v][s][p][l][k] += Y[v][j][p][l][k] * A[j * n + s];
+            std::fill(&Y[0][0][0][0][0],
+                      &Y[0][0][0][0][0] + sizeof(W) / sizeof(T), T{0.});
+            A = &(vA[pA[ma++]]); // A2
+            ASGARD_PRAGMA_OMP_SIMD(collapse(6))
             for (int v = 0; v < n; v++)
               for (int p = 0; p < n; p++)
                 for (int j = 0; j < n; j++)
                   for (int s = 0; s < n; s++)
                     for (int l = 0; l < n; l++)
                       for (int k = 0; k < n; k++)
-                        Y[w][v][p][s][l][k] +=
-                            W[w][v][p][j][l][k] * A[j * n + s];
-          std::fill(&W[0][0][0][0][0][0],
-                    &W[0][0][0][0][0][0] + sizeof(W) / sizeof(T), T{0.});
-          A = &(vA[iA[ma++]]); // A1
-          ASGARD_PRAGMA_OMP_SIMD(collapse(7))
-          for (int w = 0; w < n; w++)
+                        Y[v][p][s][l][k] += W[v][p][j][l][k] * A[j * n + s];
+            std::fill(&W[0][0][0][0][0],
+                      &W[0][0][0][0][0] + sizeof(W) / sizeof(T), T{0.});
+            A = &(vA[pA[ma++]]); // A1
+            ASGARD_PRAGMA_OMP_SIMD(collapse(6))
             for (int v = 0; v < n; v++)
               for (int p = 0; p < n; p++)
                 for (int l = 0; l < n; l++)
                   for (int j = 0; j < n; j++)
                     for (int s = 0; s < n; s++)
                       for (int k = 0; k < n; k++)
-                        W[w][v][p][l][s][k] +=
-                            Y[w][v][p][l][j][k] * A[j * n + s];
-          std::fill(&Y[0][0][0][0][0][0],
-                    &Y[0][0][0][0][0][0] + sizeof(W) / sizeof(T), T{0.});
-          A = &(vA[iA[ma++]]); // A0
-          ASGARD_PRAGMA_OMP_SIMD(collapse(7))
-          for (int w = 0; w < n; w++)
+                        W[v][p][l][s][k] += Y[v][p][l][j][k] * A[j * n + s];
+            std::fill(&Y[0][0][0][0][0],
+                      &Y[0][0][0][0][0] + sizeof(W) / sizeof(T), T{0.});
+            A = &(vA[pA[ma++]]); // A0
+            ASGARD_PRAGMA_OMP_SIMD(collapse(6))
             for (int v = 0; v < n; v++)
               for (int p = 0; p < n; p++)
                 for (int l = 0; l < n; l++)
                   for (int k = 0; k < n; k++)
                     for (int j = 0; j < n; j++)
                       for (int s = 0; s < n; s++)
-                        Y[w][v][p][l][k][s] +=
-                            A[j * n + s] * W[w][v][p][l][k][j];
-          ASGARD_PRAGMA_OMP_SIMD(collapse(6))
-          for (int j = 0; j < n; j++)
-            for (int w = 0; w < n; w++)
+                        Y[v][p][l][k][s] += A[j * n + s] * W[v][p][l][k][j];
+            ASGARD_PRAGMA_OMP_SIMD(collapse(5))
+            for (int j = 0; j < n; j++)
               for (int v = 0; v < n; v++)
                 for (int p = 0; p < n; p++)
                   for (int l = 0; l < n; l++)
                     for (int k = 0; k < n; k++)
                       if constexpr (alpha_case == scalar_case::one)
-                        y[ti + n * n * n * n * n * j + n * n * n * n * w +
-                          n * n * n * v + n * n * p + n * l + k] +=
-                            Y[j][w][v][p][l][k];
+                        y[ti + n * n * n * n * j + n * n * n * v + n * n * p +
+                          n * l + k] += Y[j][v][p][l][k];
                       else if constexpr (alpha_case == scalar_case::neg_one)
-                        y[ti + n * n * n * n * n * j + n * n * n * n * w +
-                          n * n * n * v + n * n * p + n * l + k] -=
-                            Y[j][w][v][p][l][k];
+                        y[ti + n * n * n * n * j + n * n * n * v + n * n * p +
+                          n * l + k] -= Y[j][v][p][l][k];
                       else
-                        y[ti + n * n * n * n * n * j + n * n * n * n * w +
-                          n * n * n * v + n * n * p + n * l + k] +=
-                            alpha * Y[j][w][v][p][l][k];
+                        y[ti + n * n * n * n * j + n * n * n * v + n * n * p +
+                          n * l + k] += alpha * Y[j][v][p][l][k];
+          }
+          else if constexpr (dimensions == 6)
+          {
+            T W[n][n][n][n][n][n] = {{{{{{{0}}}}}}},
+              Y[n][n][n][n][n][n] = {{{{{{{0}}}}}}};
+            T const *A            = &(vA[pA[ma++]]); // A5
+            ASGARD_PRAGMA_OMP_SIMD(collapse(7))
+            for (int j = 0; j < n; j++)
+              for (int s = 0; s < n; s++)
+                for (int w = 0; w < n; w++)
+                  for (int v = 0; v < n; v++)
+                    for (int p = 0; p < n; p++)
+                      for (int l = 0; l < n; l++)
+                        for (int k = 0; k < n; k++)
+                          W[s][w][v][p][l][k] +=
+                              x[tj + n * n * n * n * n * j + n * n * n * n * w +
+                                n * n * n * v + n * n * p + n * l + k] *
+                              A[j * n + s];
+            A = &(vA[pA[ma++]]); // A4
+            ASGARD_PRAGMA_OMP_SIMD(collapse(7))
+            for (int w = 0; w < n; w++)
+              for (int j = 0; j < n; j++)
+                for (int s = 0; s < n; s++)
+                  for (int v = 0; v < n; v++)
+                    for (int p = 0; p < n; p++)
+                      for (int l = 0; l < n; l++)
+                        for (int k = 0; k < n; k++)
+                          Y[w][s][v][p][l][k] +=
+                              W[w][j][v][p][l][k] * A[j * n + s];
+            std::fill(&W[0][0][0][0][0][0],
+                      &W[0][0][0][0][0][0] + sizeof(W) / sizeof(T), T{0.});
+            A = &(vA[pA[ma++]]); // A3
+            for (int w = 0; w < n; w++)
+              for (int v = 0; v < n; v++)
+                for (int j = 0; j < n; j++)
+                  for (int s = 0; s < n; s++)
+                    for (int p = 0; p < n; p++)
+                      for (int l = 0; l < n; l++)
+                        for (int k = 0; k < n; k++)
+                          W[w][v][s][p][l][k] +=
+                              Y[w][v][j][p][l][k] * A[j * n + s];
+            std::fill(&Y[0][0][0][0][0][0],
+                      &Y[0][0][0][0][0][0] + sizeof(W) / sizeof(T), T{0.});
+            A = &(vA[pA[ma++]]); // A2
+            ASGARD_PRAGMA_OMP_SIMD(collapse(7))
+            for (int w = 0; w < n; w++)
+              for (int v = 0; v < n; v++)
+                for (int p = 0; p < n; p++)
+                  for (int j = 0; j < n; j++)
+                    for (int s = 0; s < n; s++)
+                      for (int l = 0; l < n; l++)
+                        for (int k = 0; k < n; k++)
+                          Y[w][v][p][s][l][k] +=
+                              W[w][v][p][j][l][k] * A[j * n + s];
+            std::fill(&W[0][0][0][0][0][0],
+                      &W[0][0][0][0][0][0] + sizeof(W) / sizeof(T), T{0.});
+            A = &(vA[pA[ma++]]); // A1
+            ASGARD_PRAGMA_OMP_SIMD(collapse(7))
+            for (int w = 0; w < n; w++)
+              for (int v = 0; v < n; v++)
+                for (int p = 0; p < n; p++)
+                  for (int l = 0; l < n; l++)
+                    for (int j = 0; j < n; j++)
+                      for (int s = 0; s < n; s++)
+                        for (int k = 0; k < n; k++)
+                          W[w][v][p][l][s][k] +=
+                              Y[w][v][p][l][j][k] * A[j * n + s];
+            std::fill(&Y[0][0][0][0][0][0],
+                      &Y[0][0][0][0][0][0] + sizeof(W) / sizeof(T), T{0.});
+            A = &(vA[pA[ma++]]); // A0
+            ASGARD_PRAGMA_OMP_SIMD(collapse(7))
+            for (int w = 0; w < n; w++)
+              for (int v = 0; v < n; v++)
+                for (int p = 0; p < n; p++)
+                  for (int l = 0; l < n; l++)
+                    for (int k = 0; k < n; k++)
+                      for (int j = 0; j < n; j++)
+                        for (int s = 0; s < n; s++)
+                          Y[w][v][p][l][k][s] +=
+                              A[j * n + s] * W[w][v][p][l][k][j];
+            ASGARD_PRAGMA_OMP_SIMD(collapse(6))
+            for (int j = 0; j < n; j++)
+              for (int w = 0; w < n; w++)
+                for (int v = 0; v < n; v++)
+                  for (int p = 0; p < n; p++)
+                    for (int l = 0; l < n; l++)
+                      for (int k = 0; k < n; k++)
+                        if constexpr (alpha_case == scalar_case::one)
+                          y[ti + n * n * n * n * n * j + n * n * n * n * w +
+                            n * n * n * v + n * n * p + n * l + k] +=
+                              Y[j][w][v][p][l][k];
+                        else if constexpr (alpha_case == scalar_case::neg_one)
+                          y[ti + n * n * n * n * n * j + n * n * n * n * w +
+                            n * n * n * v + n * n * p + n * l + k] -=
+                              Y[j][w][v][p][l][k];
+                        else
+                          y[ti + n * n * n * n * n * j + n * n * n * n * w +
+                            n * n * n * v + n * n * p + n * l + k] +=
+                              alpha * Y[j][w][v][p][l][k];
+          }
         }
       }
-    }
-  } // for iy loop
+    } // for iy loop
+  }
 }
 
 /*!
  * \brief Helper method that instantiates correct kernel based on alpha and beta.
  */
-template<typename T>
+template<typename T, typename index_list>
 void cpu_n0(int const d, int const rows, int const pntr[], int const indx[],
-            int const terms, int const iA[], T const vA[], T const alpha,
-            T const x[], T const beta, T y[])
+            int const terms, index_list const &iA, T const vA[],
+            T const alpha, T const x[], T const beta, T y[])
 {
   if (beta == 0)
   {
@@ -490,10 +503,10 @@ void cpu_n0(int const d, int const rows, int const pntr[], int const indx[],
 /*!
  * \brief Helper method that instantiates correct kernel based on alpha and beta.
  */
-template<typename T, int d, int n>
+template<typename T, int d, int n, typename index_list>
 void cpu_sparse(int const rows, int const pntr[], int const indx[],
-                int const terms, int const iA[], T const vA[], T const alpha,
-                T const x[], T const beta, T y[])
+                int const terms, index_list const &iA, T const vA[],
+                T const alpha, T const x[], T const beta, T y[])
 {
   if (beta == 0)
   {
@@ -548,10 +561,10 @@ void cpu_sparse(int const rows, int const pntr[], int const indx[],
 /*!
  * \brief Helper method that instantiates correct kernel based on alpha and beta.
  */
-template<typename T, int d>
+template<typename T, int d, typename index_list>
 void cpu_sparse(int const n, int const rows, int const pntr[], int const indx[],
-                int const terms, int const iA[], T const vA[], T const alpha,
-                T const x[], T const beta, T y[])
+                int const terms, index_list const &iA, T const vA[],
+                T const alpha, T const x[], T const beta, T y[])
 {
   if (beta == 0)
   {
@@ -603,11 +616,15 @@ void cpu_sparse(int const n, int const rows, int const pntr[], int const indx[],
   }
 }
 
-template<typename T>
-void cpu_sparse(int const dimensions, int const n, int const num_rows,
-                int const pntr[], int const indx[], int const num_terms,
-                int const iA[], T const vA[], T const alpha, T const x[],
-                T const beta, T y[])
+/*!
+ * \brief Selects the kernel based on the dimensions and n.
+ */
+template<typename T, typename index_list>
+void cpu_sparse_dispatch(int const dimensions, int const n, int const num_rows,
+                         int const pntr[], int const indx[],
+                         int const num_terms, index_list const &iA,
+                         T const vA[], T const alpha, T const x[],
+                         T const beta, T y[])
 {
   switch (dimensions)
   {
@@ -767,22 +784,83 @@ void cpu_sparse(int const dimensions, int const n, int const num_rows,
   }
 }
 
+template<typename T>
+void cpu_sparse(int const dimensions, int const n, int const num_rows,
+                int const pntr[], int const indx[], int const num_terms,
+                int const iA[], T const vA[], T const alpha, T const x[],
+                T const beta, T y[])
+{
+  cpu_sparse_dispatch(dimensions, n, num_rows, pntr, indx, num_terms,
+                      full_index_list{iA, num_terms * dimensions}, vA, alpha,
+                      x, beta, y);
+}
+
+template<typename T>
+void cpu_sparse_packed(int const dimensions, int const n, int const num_rows,
+                       int const pntr[], int const indx[],
+                       int const num_terms, int const iA[], T const vA[],
+                       T const alpha, T const x[], T const beta, T y[])
+{
+  cpu_sparse_dispatch(
+      dimensions, n, num_rows, pntr, indx, num_terms,
+      packed_index_list(dimensions, n, num_terms, num_rows, iA), vA, alpha, x,
+      beta, y);
+}
+
+template<typename T>
+void cpu_n0_combine(int const dimensions, int const num_rows, int const pntr[],
+                    int const num_terms, int const iA[], T const vA[],
+                    T vals[])
+{
+#pragma omp parallel for
+  for (int iy = 0; iy < num_rows; iy++)
+  {
+    for (int jx = pntr[iy]; jx < pntr[iy + 1]; jx++)
+    {
+      int const *pA = iA + int64_t{jx} * num_terms * dimensions;
+
+      T sum = 0;
+      for (int t = 0; t < num_terms; t++)
+      {
+        T totalA = 1;
+        for (int d = 0; d < dimensions; d++)
+          totalA *= vA[*pA++];
+        sum += totalA;
+      }
+      vals[jx] = sum;
+    }
+  }
+}
+
 #ifndef ASGARD_USE_CUDA // no need to compile for the CPU if CUDA is on
 #ifdef ASGARD_ENABLE_DOUBLE
+template void cpu_n0_combine<double>(int const, int const, int const[],
+                                     int const, int const[], double const[],
+                                     double[]);
 template void cpu_sparse<double>(int const, int const, int const, int const[],
                                  int const[], int const, int const[],
                                  double const[], double const, double const[],
                                  double const, double[]);
+template void cpu_sparse_packed<double>(int const, int const, int const,
+                                        int const[], int const[], int const,
+                                        int const[], double const[],
+                                        double const, double const[],
+                                        double const, double[]);
 #endif
 
 #ifdef ASGARD_ENABLE_FLOAT
+template void cpu_n0_combine<float>(int const, int const, int const[],
+                                    int const, int const[], float const[],
+                                    float[]);
 template void cpu_sparse<float>(int const, int const, int const, int const[],
                                 int const[], int const, int const[],
                                 float const[], float const, float const[],
                                 float const, float[]);
+template void cpu_sparse_packed<float>(int const, int const, int const,
+                                       int const[], int const[], int const,
+                                       int const[], float const[], float const,
+                                       float const[], float const, float[]);
 #endif
 #endif
 
 } // namespace asgard::kronmult
-
-#endif // KRON_MODE_GLOBAL
@@ -7,6 +7,64 @@
 
 namespace asgard::kronmult
 {
+/*!
+ * \brief Reads the operator indexes of a (row, col) pair from the full list
+ *
+ * The indexes are stored explicitly, num_terms * dimensions per pair.
+ */
+struct full_index_list
+{
+  int const *iA;
+  int const stride;
+
+  int scratch_size() const { return 0; }
+  int const *operator()(int, int jx, int *) const
+  {
+    return iA + static_cast<int64_t>(jx) * stride;
+  }
+};
+
+/*!
+ * \brief Decodes the operator indexes of a (row, col) pair from a packed list
+ *
+ * See cpu_sparse_packed() for the format, the indexes for all terms
+ * are written into the scratch space of size num_terms * dimensions.
+ */
+struct packed_index_list
+{
+  packed_index_list(int dims, int n, int terms, int num_rows, int const iA[])
+      : dimensions(dims), num_terms(terms), kron_squared(n * n),
+        block1d_size(dims * terms * n * n), rbase(iA),
+        local(iA + static_cast<int64_t>(num_rows) * dims)
+  {}
+
+  int scratch_size() const { return dimensions * num_terms; }
+  int const *operator()(int iy, int jx, int *scratch) const
+  {
+    int const *rb    = rbase + static_cast<int64_t>(iy) * dimensions;
+    int64_t const lj = static_cast<int64_t>(jx) * dimensions;
+    for (int d = 0; d < dimensions; d++)
+    {
+      int64_t const l = lj + d;
+      int const c     = static_cast<int>(
+          (static_cast<uint32_t>(local[l / 2]) >> (16 * (l % 2))) & 0xFFFFu);
+      scratch[d] = rb[d] + c * block1d_size;
+    }
+    for (int t = 1; t < num_terms; t++)
+      for (int d = 0; d < dimensions; d++)
+        scratch[t * dimensions + d] =
+            scratch[d] + t * dimensions * kron_squared;
+    return scratch;
+  }
+
+  int const dimensions;
+  int const num_terms;
+  int const kron_squared;
+  int const block1d_size;
+  int const *rbase;
+  int const *local;
+};
+
 template<typename T, int dimensions>
 class tensor
 {
@@ -70,9 +128,9 @@ private:
 };
 
 template<typename T, int dimensions, scalar_case alpha_case,
-         scalar_case beta_case>
+         scalar_case beta_case, typename index_list>
 void cpu_sparse(int const n, int const num_rows, int const pntr[],
-                int const indx[], int const num_terms, int const iA[],
+                int const indx[], int const num_terms, index_list const &iA,
                 T const vA[], T const alpha, T const x[], T const beta, T y[])
 {
   (void)alpha;
@@ -81,6 +139,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
 #pragma omp parallel
   {
     tensor<T, dimensions> Y(n), W(n);
+    std::vector<int> scratch(iA.scratch_size());
 
 // always use one thread per kron-product
 #pragma omp for
@@ -98,11 +157,12 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
         for (size_t j = 0; j < Y.size(); j++)
           y[ti + j] *= beta;
 
-      // ma is the starting index of the operators for this y
-      int ma = pntr[iy] * num_terms * dimensions;
-
       for (int jx = pntr[iy]; jx < pntr[iy + 1]; jx++)
       {
+        // the operator indexes for this (row, col) pair
+        int const *const pA = iA(iy, jx, scratch.data());
+        int ma = 0;
+
         // tensor i (ti) is the first index of this tensor in x
         int const tj = indx[jx] * Y.size();
         for (int t = 0; t < num_terms; t++)
@@ -110,7 +170,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
           if constexpr (dimensions == 1)
           {
             Y.zero();
-            T const *const A = &(vA[iA[ma++]]);
+            T const *const A = &(vA[pA[ma++]]);
             ASGARD_PRAGMA_OMP_SIMD(collapse(2))
             for (int j = 0; j < n; j++)
               for (int k = 0; k < n; k++)
@@ -129,13 +189,13 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
           {
             Y.zero();
             W.zero();
-            T const *A = &(vA[iA[ma++]]); // A1
+            T const *A = &(vA[pA[ma++]]); // A1
             ASGARD_PRAGMA_OMP_SIMD(collapse(3))
             for (int j = 0; j < n; j++)
               for (int s = 0; s < n; s++)
                 for (int k = 0; k < n; k++)
                   W(s, k) += x[tj + n * j + k] * A[j * n + s];
-            A = &(vA[iA[ma++]]); // A0
+            A = &(vA[pA[ma++]]); // A0
             ASGARD_PRAGMA_OMP_SIMD(collapse(3))
             for (int j = 0; j < n; j++)
               for (int k = 0; k < n; k++)
@@ -155,14 +215,14 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
           {
             Y.zero();
             W.zero();
-            T const *A = &(vA[iA[ma++]]); // A2
+            T const *A = &(vA[pA[ma++]]); // A2
             ASGARD_PRAGMA_OMP_SIMD(collapse(4))
             for (int j = 0; j < n; j++)
               for (int s = 0; s < n; s++)
                 for (int l = 0; l < n; l++)
                   for (int k = 0; k < n; k++)
                     Y(s, l, k) += x[tj + n * n * j + n * l + k] * A[j * n + s];
-            A = &(vA[iA[ma++]]); // A1
+            A = &(vA[pA[ma++]]); // A1
             ASGARD_PRAGMA_OMP_SIMD(collapse(4))
             for (int l = 0; l < n; l++)
               for (int j = 0; j < n; j++)
@@ -170,7 +230,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
                   for (int k = 0; k < n; k++)
                     W(l, s, k) += Y(l, j, k) * A[j * n + s];
             Y.zero();
-            A = &(vA[iA[ma++]]); // A0
+            A = &(vA[pA[ma++]]); // A0
             ASGARD_PRAGMA_OMP_SIMD(collapse(4))
             for (int l = 0; l < n; l++)
               for (int k = 0; k < n; k++)
@@ -192,7 +252,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
           {
             Y.zero();
             W.zero();
-            T const *A = &(vA[iA[ma++]]); // A3
+            T const *A = &(vA[pA[ma++]]); // A3
             ASGARD_PRAGMA_OMP_SIMD(collapse(5))
             for (int j = 0; j < n; j++)
               for (int s = 0; s < n; s++)
@@ -202,7 +262,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
                       W(s, p, l, k) +=
                           x[tj + n * n * n * j + n * n * p + n * l + k] *
                           A[j * n + s];
-            A = &(vA[iA[ma++]]); // A2
+            A = &(vA[pA[ma++]]); // A2
             ASGARD_PRAGMA_OMP_SIMD(collapse(5))
             for (int p = 0; p < n; p++)
               for (int j = 0; j < n; j++)
@@ -211,7 +271,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
                     for (int k = 0; k < n; k++)
                       Y(p, s, l, k) += W(p, j, l, k) * A[j * n + s];
             W.zero();
-            A = &(vA[iA[ma++]]); // A1
+            A = &(vA[pA[ma++]]); // A1
             ASGARD_PRAGMA_OMP_SIMD(collapse(5))
             for (int p = 0; p < n; p++)
               for (int l = 0; l < n; l++)
@@ -220,7 +280,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
                     for (int k = 0; k < n; k++)
                       W(p, l, s, k) += Y(p, l, j, k) * A[j * n + s];
             Y.zero();
-            A = &(vA[iA[ma++]]); // A0
+            A = &(vA[pA[ma++]]); // A0
             ASGARD_PRAGMA_OMP_SIMD(collapse(5))
             for (int p = 0; p < n; p++)
               for (int l = 0; l < n; l++)
@@ -247,7 +307,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
           {
             Y.zero();
             W.zero();
-            T const *A = &(vA[iA[ma++]]); // A4
+            T const *A = &(vA[pA[ma++]]); // A4
             ASGARD_PRAGMA_OMP_SIMD(collapse(6))
             for (int j = 0; j < n; j++)
               for (int s = 0; s < n; s++)
@@ -259,7 +319,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
                             x[tj + n * n * n * n * j + n * n * n * v +
                               n * n * p + n * l + k] *
                             A[j * n + s];
-            A = &(vA[iA[ma++]]); // A3
+            A = &(vA[pA[ma++]]); // A3
             ASGARD_PRAGMA_OMP_SIMD(collapse(6))
             for (int v = 0; v < n; v++)
               for (int j = 0; j < n; j++)
@@ -269,7 +329,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
                       for (int k = 0; k < n; k++)
                         W(v, s, p, l, k) += Y(v, j, p, l, k) * A[j * n + s];
             Y.zero();
-            A = &(vA[iA[ma++]]); // A2
+            A = &(vA[pA[ma++]]); // A2
             ASGARD_PRAGMA_OMP_SIMD(collapse(6))
             for (int v = 0; v < n; v++)
               for (int p = 0; p < n; p++)
@@ -279,7 +339,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
                       for (int k = 0; k < n; k++)
                         Y(v, p, s, l, k) += W(v, p, j, l, k) * A[j * n + s];
             W.zero();
-            A = &(vA[iA[ma++]]); // A1
+            A = &(vA[pA[ma++]]); // A1
             ASGARD_PRAGMA_OMP_SIMD(collapse(6))
             for (int v = 0; v < n; v++)
               for (int p = 0; p < n; p++)
@@ -289,7 +349,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
                       for (int k = 0; k < n; k++)
                         W(v, p, l, s, k) += Y(v, p, l, j, k) * A[j * n + s];
             Y.zero();
-            A = &(vA[iA[ma++]]); // A0
+            A = &(vA[pA[ma++]]); // A0
             ASGARD_PRAGMA_OMP_SIMD(collapse(6))
             for (int v = 0; v < n; v++)
               for (int p = 0; p < n; p++)
@@ -317,7 +377,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
           else if constexpr (dimensions == 6)
           {
             W.zero();
-            T const *A = &(vA[iA[ma++]]); // A5
+            T const *A = &(vA[pA[ma++]]); // A5
             ASGARD_PRAGMA_OMP_SIMD(collapse(7))
             for (int j = 0; j < n; j++)
               for (int s = 0; s < n; s++)
@@ -331,7 +391,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
                                 n * n * n * v + n * n * p + n * l + k] *
                               A[j * n + s];
             Y.zero();
-            A = &(vA[iA[ma++]]); // A4
+            A = &(vA[pA[ma++]]); // A4
             ASGARD_PRAGMA_OMP_SIMD(collapse(7))
             for (int w = 0; w < n; w++)
               for (int j = 0; j < n; j++)
@@ -343,7 +403,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
                           Y(w, s, v, p, l, k) +=
                               W(w, j, v, p, l, k) * A[j * n + s];
             W.zero();
-            A = &(vA[iA[ma++]]); // A3
+            A = &(vA[pA[ma++]]); // A3
             ASGARD_PRAGMA_OMP_SIMD(collapse(7))
             for (int w = 0; w < n; w++)
               for (int v = 0; v < n; v++)
@@ -355,7 +415,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
                           W(w, v, s, p, l, k) +=
                               Y(w, v, j, p, l, k) * A[j * n + s];
             Y.zero();
-            A = &(vA[iA[ma++]]); // A2
+            A = &(vA[pA[ma++]]); // A2
             ASGARD_PRAGMA_OMP_SIMD(collapse(7))
             for (int w = 0; w < n; w++)
               for (int v = 0; v < n; v++)
@@ -367,7 +427,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
                           Y(w, v, p, s, l, k) +=
                               W(w, v, p, j, l, k) * A[j * n + s];
             W.zero();
-            A = &(vA[iA[ma++]]); // A1
+            A = &(vA[pA[ma++]]); // A1
             ASGARD_PRAGMA_OMP_SIMD(collapse(7))
             for (int w = 0; w < n; w++)
               for (int v = 0; v < n; v++)
@@ -379,7 +439,7 @@ void cpu_sparse(int const n, int const num_rows, int const pntr[],
                           W(w, v, p, l, s, k) +=
                               Y(w, v, p, l, j, k) * A[j * n + s];
             Y.zero();
-            A = &(vA[iA[ma++]]); // A0
+            A = &(vA[pA[ma++]]); // A0
             ASGARD_PRAGMA_OMP_SIMD(collapse(7))
             for (int w = 0; w < n; w++)
               for (int v = 0; v < n; v++)
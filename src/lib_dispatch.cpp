@@ -54,6 +54,17 @@ extern "C"
                int *ldb, int *info);
 #endif
 
+  // --------------------------------------------------------------------------
+  // eigenvalues and eigenvectors of a general matrix
+  // --------------------------------------------------------------------------
+  void dgeev_(char *jobvl, char *jobvr, int *n, double *A, int *lda, double *wr,
+              double *wi, double *vl, int *ldvl, double *vr, int *ldvr,
+              double *work, int *lwork, int *info);
+
+  void sgeev_(char *jobvl, char *jobvr, int *n, float *A, int *lda, float *wr,
+              float *wi, float *vl, int *ldvl, float *vr, int *ldvr,
+              float *work, int *lwork, int *info);
+
 #ifndef ASGARD_OPENBLAS
   //  Openblas predeclares these from an include in cblas.h
   void dgesv_(int *n, int *nrhs, double *A, int *lda, int *ipiv, double *b,
@@ -1129,6 +1140,43 @@ int getrs(char trans, int n, int nrhs, P const *A, int lda, int const *ipiv,
   return info;
 }
 
+template<typename P>
+int geev(char jobvl, char jobvr, int n, P *A, int lda, P *wr, P *wi, P *vl,
+         int ldvl, P *vr, int ldvr)
+{
+  expect(A);
+  expect(wr);
+  expect(wi);
+  expect(lda >= 1);
+  expect(ldvl >= 1);
+  expect(ldvr >= 1);
+  expect(n >= 0);
+
+  int info{1};
+  // the first call queries the size of the workspace
+  int lwork = -1;
+  P wsize   = 0;
+  if constexpr (std::is_same_v<P, double>)
+  {
+    dgeev_(&jobvl, &jobvr, &n, A, &lda, wr, wi, vl, &ldvl, vr, &ldvr, &wsize,
+           &lwork, &info);
+    lwork = static_cast<int>(wsize);
+    std::vector<P> work(lwork);
+    dgeev_(&jobvl, &jobvr, &n, A, &lda, wr, wi, vl, &ldvl, vr, &ldvr,
+           work.data(), &lwork, &info);
+  }
+  else if constexpr (std::is_same_v<P, float>)
+  {
+    sgeev_(&jobvl, &jobvr, &n, A, &lda, wr, wi, vl, &ldvl, vr, &ldvr, &wsize,
+           &lwork, &info);
+    lwork = static_cast<int>(wsize);
+    std::vector<P> work(lwork);
+    sgeev_(&jobvl, &jobvr, &n, A, &lda, wr, wi, vl, &ldvl, vr, &ldvr,
+           work.data(), &lwork, &info);
+  }
+  return info;
+}
+
 template<typename P>
 int pttrf(int n, P *D, P *E)
 {
@@ -1300,14 +1348,17 @@ void sparse_gemv(char const trans, int rows, int cols, int nnz,
     // TODO: only non-transpose case implemented
     expect(trans == 'n');
 
+#pragma omp parallel for
     for (int i = 0; i < rows; i++)
     {
-      y[i] *= beta;
       // sparse case, iterate over number of column entries in the current row
+      P sum = 0;
       for (int col = row_offsets[i]; col < row_offsets[i + 1]; col++)
       {
-        y[i] += alpha * vals[col] * x[col_indices[col]];
+        sum += vals[col] * x[col_indices[col]];
       }
+      // beta = 0 overwrites y, as in the BLAS gemv
+      y[i] = (beta == 0) ? alpha * sum : beta * y[i] + alpha * sum;
     }
   }
 }
@@ -1354,6 +1405,8 @@ template void tpsv<resource::host, float>(const char uplo, const char trans,
                                           const char diag, const int n,
                                           const float *ap, float *x,
                                           const int incx);
+template int geev(char jobvl, char jobvr, int n, float *A, int lda, float *wr,
+                  float *wi, float *vl, int ldvl, float *vr, int ldvr);
 template int pttrf(int n, float *D, float *E);
 template int
 pttrs(int n, int nrhs, float const *D, float const *E, float *B, int ldb);
@@ -1411,6 +1464,9 @@ template void tpsv<resource::host, double>(const char uplo, const char trans,
                                            const int incx);
 template int getrs(char trans, int n, int nrhs, double const *A, int lda,
                    int const *ipiv, double *b, int ldb);
+template int geev(char jobvl, char jobvr, int n, double *A, int lda,
+                  double *wr, double *wi, double *vl, int ldvl, double *vr,
+                  int ldvr);
 template int pttrf(int n, double *D, double *E);
 template int
 pttrs(int n, int nrhs, double const *D, double const *E, double *B, int ldb);
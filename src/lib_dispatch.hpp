@@ -70,6 +70,11 @@ template<typename P>
 int getrs(char trans, int n, int nrhs, P const *A, int lda, int const *ipiv,
           P *b, int ldb);
 
+//! \brief Eigenvalues (wr + i * wi) and eigenvectors of a general matrix, host only
+template<typename P>
+int geev(char jobvl, char jobvr, int n, P *A, int lda, P *wr, P *wi, P *vl,
+         int ldvl, P *vr, int ldvr);
+
 template<typename P>
 int pttrf(int n, P *D, P *E);
 
@@ -85,6 +85,10 @@ struct gmres_info
 {
   P error;
   int iterations;
+  // number of recycled Krylov vectors used in the solve, 0 without recycling
+  int recycled = 0;
+  // products spent to update the recycled vectors, included in iterations
+  int recycle_products = 0;
 };
 
 template<typename P>
@@ -74,15 +74,35 @@ parser::parser(int argc, char const *const *argv)
           "implicit)") |
       clara::detail::Opt(memory_limit, "size > 0")["--memory"](
           "Maximum workspace size in MB that will be resident on an "
-          "accelerator") |
+          "accelerator, or in RAM for the CPU out-of-core local kronmult") |
       clara::detail::Opt(kmode_str, "dense/sparse")["--kron-mode"](
           "Select dense (default) or sparse mode for the kronmult operations") |
+      clara::detail::Opt(kron_backend_str, "local/global/block/auto")["--kron-backend"](
+          "Select the kronmult algorithm, auto times each one on the grid "
+          "and uses the fastest") |
+      clara::detail::Opt(use_single_kron)["--kron-single"](
+          "Store the kronmult coefficients in single precision, "
+          "the products are still accumulated in the working precision") |
+      clara::detail::Opt(use_morton_order)["--kron-morton"](
+          "Renumber the cells of the kronmult along a Morton curve "
+          "to improve the memory locality, the results are not affected") |
+      clara::detail::Opt(precond_str, "jacobi/block-jacobi/multilevel")["--precond"](
+          "Preconditioner for the bicgstab/gmres solvers, block-jacobi "
+          "factors the diagonal block of each cell, multilevel uses "
+          "the coarser sparse grids (block kronmult only)") |
       clara::detail::Opt(gmres_tolerance, "tol > 0")["--tol"](
           "Tolerance used to determine convergence in bicgstab/gmres solvers") |
       clara::detail::Opt(gmres_inner_iterations, "inner_it > 0")["--inner_it"](
           "Number of inner iterations in gmres solver") |
       clara::detail::Opt(gmres_outer_iterations, "outer_it > 0")["--outer_it"](
           "Number of max/outer iterations in bicgstab/gmres solver") |
+      clara::detail::Opt(gmres_recycle, "recycle > 0")["--recycle"](
+          "Number of approximate eigenvectors recycled between the gmres "
+          "solves (GCRO-DR), must be less than the inner iterations") |
+      clara::detail::Opt(extrapolate, "steps > 0")["--extrapolate"](
+          "Number of previous solutions used to extrapolate the initial guess "
+          "of the implicit solver, 1 uses the last solution, 2 is linear and "
+          "up to 4 (cubic) is allowed") |
       clara::detail::Opt(max_adapt_levels_str, "")["--max_adapt_levels"](
           "Maximum hierarchical levels (resolution) for adaptivity") |
       clara::detail::Opt(restart_file, "filename")["--restart"](
@@ -392,6 +412,60 @@ parser::parser(int argc, char const *const *argv)
     valid = false;
   }
 
+  if (kron_backend_str != NO_USER_VALUE_STR)
+  {
+    if (auto const choice = kron_backend_mapping.find(kron_backend_str);
+        choice != kron_backend_mapping.end())
+    {
+      kbackend = choice->second;
+    }
+    else
+    {
+      std::cerr << "kron_backend is set to: '" << kron_backend_str
+                << "' but it must be one of 'local', 'global', 'block' or 'auto'\n";
+      valid = false;
+    }
+  }
+  if (kbackend != kron_backend::local && get_num_ranks() > 1)
+  {
+    std::cerr << "Only the local kronmult backend is implemented for MPI\n";
+    valid = false;
+  }
+
+  if (precond_str != NO_USER_VALUE_STR)
+  {
+    if (auto const choice = precond_mapping.find(precond_str);
+        choice != precond_mapping.end())
+    {
+      precond = choice->second;
+    }
+    else
+    {
+      std::cerr << "precond is set to: '" << precond_str
+                << "' but it must be 'jacobi', 'block-jacobi' or 'multilevel'\n";
+      valid = false;
+    }
+    if (solver != solve_opts::gmres && solver != solve_opts::bicgstab)
+    {
+      std::cerr << "preconditioner has no effect with solver = " << solver_str
+                << '\n';
+      valid = false;
+    }
+  }
+#ifdef ASGARD_USE_CUDA
+  if (precond != precond_opts::jacobi)
+  {
+    std::cerr << "the " << precond_str << " preconditioner is not available on the GPU\n";
+    valid = false;
+  }
+#endif
+  if (precond != precond_opts::jacobi && kbackend != kron_backend::block_global
+      && kbackend != kron_backend::automatic)
+  {
+    std::cerr << "the " << precond_str << " preconditioner requires --kron-backend block\n";
+    valid = false;
+  }
+
   if (solver != solve_opts::gmres && solver != solve_opts::bicgstab && gmres_tolerance != NO_USER_VALUE_FP)
   {
     std::cerr << "gmres tolerance has no effect with solver = " << solver_str
@@ -427,6 +501,43 @@ parser::parser(int argc, char const *const *argv)
               << '\n';
     valid = false;
   }
+  if (solver != solve_opts::gmres && gmres_recycle != DEFAULT_GMRES_RECYCLE)
+  {
+    std::cerr << "gmres recycling has no effect with solver = " << solver_str
+              << '\n';
+    valid = false;
+  }
+  if (gmres_recycle < 0)
+  {
+    std::cerr << "Number of recycled gmres vectors must be non-negative\n";
+    valid = false;
+  }
+  if (gmres_inner_iterations != NO_USER_VALUE && gmres_recycle >= gmres_inner_iterations)
+  {
+    std::cerr << "Number of recycled gmres vectors must be less than the "
+                 "inner iterations\n";
+    valid = false;
+  }
+#ifdef ASGARD_USE_CUDA
+  if (gmres_recycle != DEFAULT_GMRES_RECYCLE)
+  {
+    std::cerr << "gmres recycling is not available on the GPU\n";
+    valid = false;
+  }
+#endif
+  if (extrapolate < 0 || extrapolate > 4)
+  {
+    std::cerr << "Number of extrapolated solutions must be between 0 and 4\n";
+    valid = false;
+  }
+  if (extrapolate != DEFAULT_EXTRAPOLATE &&
+      ((!use_implicit_stepping && !use_imex_stepping) ||
+       (solver != solve_opts::gmres && solver != solve_opts::bicgstab)))
+  {
+    std::cerr << "Extrapolation of the initial guess requires implicit or imex "
+                 "stepping with the gmres or bicgstab solver\n";
+    valid = false;
+  }
   if (max_adapt_levels_str != NO_USER_VALUE_STR)
   {
     max_adapt_levels = ints_from_string(max_adapt_levels_str);
@@ -476,6 +587,8 @@ bool parser::using_implicit() const { return use_implicit_stepping; }
 bool parser::using_imex() const { return use_imex_stepping; }
 bool parser::using_full_grid() const { return use_full_grid; }
 bool parser::using_linf_nrm() const { return use_linf_nrm; }
+bool parser::using_single_kron() const { return use_single_kron; }
+bool parser::using_morton_order() const { return use_morton_order; }
 bool parser::do_poisson_solve() const { return do_poisson; }
 bool parser::do_adapt_levels() const { return do_adapt; }
 bool parser::do_restart() const { return restart_file != NO_USER_VALUE_STR; }
@@ -488,6 +601,8 @@ int parser::get_mixed_grid_group() const { return mixed_grid_group; }
 int parser::get_time_steps() const { return num_time_steps; }
 int parser::get_memory_limit() const { return memory_limit; }
 kronmult_mode parser::get_kmode() const { return kmode; }
+kron_backend parser::get_kron_backend() const { return kbackend; }
+precond_opts parser::get_precond() const { return precond; }
 int parser::get_wavelet_output_freq() const { return wavelet_output_freq; }
 int parser::get_realspace_output_freq() const { return realspace_output_freq; }
 int parser::get_gmres_inner_iterations() const
@@ -498,6 +613,8 @@ int parser::get_gmres_outer_iterations() const
 {
   return gmres_outer_iterations;
 }
+int parser::get_gmres_recycle() const { return gmres_recycle; }
+int parser::get_extrapolate() const { return extrapolate; }
 
 fk::vector<int> parser::get_max_adapt_levels() const
 {
@@ -555,6 +672,12 @@ void parser_mod::set(parser &p, parser_option_entry entry, int value)
   case gmres_outer_iterations:
     p.gmres_outer_iterations = value;
     break;
+  case gmres_recycle:
+    p.gmres_recycle = value;
+    break;
+  case extrapolate:
+    p.extrapolate = value;
+    break;
   default:
     throw std::runtime_error(
         "Insider parser_mod::set, setting int to non-int entry.");
@@ -582,6 +705,12 @@ void parser_mod::set(parser &p, parser_option_entry entry, bool value)
   case use_imex_stepping:
     p.use_imex_stepping = value;
     break;
+  case use_single_kron:
+    p.use_single_kron = value;
+    break;
+  case use_morton_order:
+    p.use_morton_order = value;
+    break;
   default:
     throw std::runtime_error(
         "Insider parser_mod::set, setting bool to non-bool entry.");
@@ -624,6 +753,14 @@ void parser_mod::set(parser &p, parser_option_entry entry,
     p.solver_str = value;
     p.solver     = solver_mapping.at(value);
     break;
+  case kron_backend_str:
+    p.kron_backend_str = value;
+    p.kbackend         = kron_backend_mapping.at(value);
+    break;
+  case precond_str:
+    p.precond_str = value;
+    p.precond     = precond_mapping.at(value);
+    break;
   case pde_str:
     p.pde_str    = value;
     p.pde_choice = pde_mapping.at(value).pde_choice;
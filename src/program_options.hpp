@@ -78,6 +78,47 @@ enum class kronmult_mode
   sparse
 };
 
+/*!
+ * \brief Indicates the algorithm used for the kronmult operations.
+ */
+enum class kron_backend
+{
+  //! \brief Local kronmult, dense or sparse according to the kronmult_mode.
+  local,
+  //! \brief Global kronmult, explicitly forms the sparse matrices.
+  global,
+  //! \brief Block-global kronmult, works directly with the cells (CPU only).
+  block_global,
+  //! \brief Times a few products with each backend and picks the fastest.
+  automatic
+};
+
+using kron_backend_map_t = std::map<std::string_view, kron_backend>;
+static kron_backend_map_t const kron_backend_mapping = {
+    {"local", kron_backend::local},
+    {"global", kron_backend::global},
+    {"block", kron_backend::block_global},
+    {"auto", kron_backend::automatic}};
+
+/*!
+ * \brief Indicates the preconditioner used by the iterative implicit solvers.
+ */
+enum class precond_opts
+{
+  //! \brief Pointwise diagonal (Jacobi) preconditioner.
+  jacobi,
+  //! \brief Dense diagonal blocks for each cell, needs the block kronmult.
+  block_jacobi,
+  //! \brief V-cycle over the sparse grid levels, needs the block kronmult.
+  multilevel
+};
+
+using precond_map_t = std::map<std::string_view, precond_opts>;
+static precond_map_t const precond_mapping = {
+    {"jacobi", precond_opts::jacobi},
+    {"block-jacobi", precond_opts::block_jacobi},
+    {"multilevel", precond_opts::multilevel}};
+
 class PDE_descriptor
 {
 public:
@@ -217,6 +258,8 @@ public:
   static auto constexpr DEFAULT_USE_IMEX          = false;
   static auto constexpr DEFAULT_USE_FG            = false;
   static auto constexpr DEFAULT_USE_LINF_NRM      = false;
+  static auto constexpr DEFAULT_USE_SINGLE_KRON   = false;
+  static auto constexpr DEFAULT_USE_MORTON_ORDER  = false;
   static auto constexpr DEFAULT_DO_POISSON        = false;
   static auto constexpr DEFAULT_DO_ADAPT          = false;
   static auto constexpr DEFAULT_PDE_STR           = "custom";
@@ -226,9 +269,19 @@ public:
   static auto constexpr DEFAULT_PDE_SELECTED_CASE = PDE_case_opts::case0;
   static auto constexpr DEFAULT_MEMORY_LIMIT_MB   = 10000;
   static auto constexpr DEFAULT_KRONMULT_MODE     = kronmult_mode::dense;
+#if defined(KRON_MODE_GLOBAL_BLOCK)
+  static auto constexpr DEFAULT_KRON_BACKEND      = kron_backend::block_global;
+#elif defined(KRON_MODE_GLOBAL)
+  static auto constexpr DEFAULT_KRON_BACKEND      = kron_backend::global;
+#else
+  static auto constexpr DEFAULT_KRON_BACKEND      = kron_backend::local;
+#endif
+  static auto constexpr DEFAULT_PRECOND           = precond_opts::jacobi;
   static auto constexpr DEFAULT_GMRES_TOLERANCE   = NO_USER_VALUE_FP;
   static auto constexpr DEFAULT_GMRES_INNER_ITERATIONS = NO_USER_VALUE;
   static auto constexpr DEFAULT_GMRES_OUTER_ITERATIONS = NO_USER_VALUE;
+  static auto constexpr DEFAULT_GMRES_RECYCLE          = 0;
+  static auto constexpr DEFAULT_EXTRAPOLATE            = 0;
   inline static fk::vector<int> const DEFAULT_MAX_ADAPT_LEVELS;
 
   // construct from command line
@@ -308,6 +361,8 @@ public:
   bool using_imex() const;
   bool using_full_grid() const;
   bool using_linf_nrm() const;
+  bool using_single_kron() const;
+  bool using_morton_order() const;
   bool do_poisson_solve() const;
   bool do_adapt_levels() const;
   bool do_restart() const;
@@ -322,11 +377,15 @@ public:
   int get_memory_limit() const;
   int get_gmres_inner_iterations() const;
   int get_gmres_outer_iterations() const;
+  int get_gmres_recycle() const;
+  int get_extrapolate() const;
 
   int get_wavelet_output_freq() const;
   int get_realspace_output_freq() const;
 
   kronmult_mode get_kmode() const;
+  kron_backend get_kron_backend() const;
+  precond_opts get_precond() const;
 
   double get_dt() const;
   double get_cfl() const;
@@ -448,10 +507,27 @@ private:
 
   kronmult_mode kmode = DEFAULT_KRONMULT_MODE;
 
+  // the kronmult algorithm, the default is set by the CMake options
+  std::string kron_backend_str = NO_USER_VALUE_STR;
+  kron_backend kbackend        = DEFAULT_KRON_BACKEND;
+
+  // store the block-global kronmult coefficients in single precision
+  bool use_single_kron = DEFAULT_USE_SINGLE_KRON;
+  // renumber the block-global kronmult cells along a Morton curve
+  bool use_morton_order = DEFAULT_USE_MORTON_ORDER;
+
+  // preconditioner for the iterative solvers
+  std::string precond_str = NO_USER_VALUE_STR;
+  precond_opts precond    = DEFAULT_PRECOND;
+
   // gmres solver parameters
   double gmres_tolerance     = DEFAULT_GMRES_TOLERANCE;
   int gmres_inner_iterations = DEFAULT_GMRES_INNER_ITERATIONS;
   int gmres_outer_iterations = DEFAULT_GMRES_OUTER_ITERATIONS;
+  // number of Krylov vectors recycled between the gmres solves, 0 is off
+  int gmres_recycle = DEFAULT_GMRES_RECYCLE;
+  // number of previous solutions used for the initial guess, 0 is off
+  int extrapolate = DEFAULT_EXTRAPOLATE;
 
   std::string max_adapt_levels_str = NO_USER_VALUE_STR;
   fk::vector<int> max_adapt_levels = DEFAULT_MAX_ADAPT_LEVELS;
@@ -477,6 +553,8 @@ struct parser_mod
     memory_limit,
     gmres_inner_iterations,
     gmres_outer_iterations,
+    gmres_recycle,
+    extrapolate,
     // bool values
     use_implicit_stepping,
     use_full_grid,
@@ -484,6 +562,8 @@ struct parser_mod
     do_poisson,
     do_adapt,
     use_imex_stepping,
+    use_single_kron,
+    use_morton_order,
     // double values
     cfl,
     dt,
@@ -491,6 +571,8 @@ struct parser_mod
     gmres_tolerance,
     // string
     solver_str,
+    kron_backend_str,
+    precond_str,
     pde_str,
     starting_levels_str,
     restart_file,
@@ -521,8 +603,12 @@ public:
         plot_freq(user_vals.get_plot_freq()),
         memory_limit(user_vals.get_memory_limit()),
         kmode(user_vals.get_kmode()),
+        kbackend(user_vals.get_kron_backend()),
+        precond(user_vals.get_precond()),
         gmres_inner_iterations(user_vals.get_gmres_inner_iterations()),
         gmres_outer_iterations(user_vals.get_gmres_outer_iterations()),
+        gmres_recycle(user_vals.get_gmres_recycle()),
+        extrapolate(user_vals.get_extrapolate()),
         use_implicit_stepping(user_vals.using_implicit()),
         use_full_grid(user_vals.using_full_grid()),
         use_linf_nrm(user_vals.using_linf_nrm()),
@@ -530,6 +616,8 @@ public:
         do_adapt_levels(user_vals.do_adapt_levels()),
         solver(user_vals.get_selected_solver()),
         use_imex_stepping(user_vals.using_imex()),
+        use_single_kron(user_vals.using_single_kron()),
+        use_morton_order(user_vals.using_morton_order()),
         max_adapt_levels(user_vals.get_max_adapt_levels()),
         restart_file(user_vals.get_restart_file()){};
 
@@ -550,8 +638,12 @@ public:
   int const plot_freq;
   int const memory_limit;
   kronmult_mode const kmode;
+  kron_backend const kbackend;
+  precond_opts const precond;
   int const gmres_inner_iterations;
   int const gmres_outer_iterations;
+  int const gmres_recycle;
+  int const extrapolate;
 
   bool const use_implicit_stepping;
   bool const use_full_grid;
@@ -562,6 +654,8 @@ public:
   solve_opts const solver;
 
   bool const use_imex_stepping;
+  bool const use_single_kron;
+  bool const use_morton_order;
 
   fk::vector<int> const max_adapt_levels;
 
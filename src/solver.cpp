@@ -110,6 +110,31 @@ void apply_diagonal_precond(gpu::vector<P> const &pc, P dt,
 }
 #endif
 
+// uses the block-Jacobi preconditioner if set, otherwise the diagonal one
+template<typename P, resource resrc>
+void apply_precond(kron_operators<P> const &ops, P dt,
+                   fk::vector<P, mem_type::view, resrc> &x)
+{
+  if constexpr (resrc == resource::host)
+  {
+    if (ops.has_block_preconditioner())
+    {
+      tools::time_event performance("kronmult - block preconditioner");
+      ops.apply_block_preconditioner(dt, x.data());
+      return;
+    }
+    if (ops.has_multilevel_preconditioner())
+    {
+      tools::time_event performance("kronmult - multilevel preconditioner");
+      ops.apply_multilevel_preconditioner(dt, x.data());
+      return;
+    }
+  }
+  auto const &pc = ops.template get_diagonal_preconditioner<resrc>();
+  tools::time_event performance("kronmult - preconditioner", pc.size());
+  apply_diagonal_precond(pc, dt, x);
+}
+
 template<typename P, resource resrc>
 gmres_info<P>
 simple_gmres_euler(const P dt, imex_flag imex,
@@ -118,21 +143,23 @@ simple_gmres_euler(const P dt, imex_flag imex,
                    fk::vector<P, mem_type::owner, resrc> const &b,
                    int const restart, int const max_iter, P const tolerance)
 {
-  auto const &pc = ops.template get_diagonal_preconditioner<resrc>();
-
-  return simple_gmres(
-      [&](P const alpha, fk::vector<P, mem_type::view, resrc> const x_in,
-          P const beta, fk::vector<P, mem_type::view, resrc> y) -> void {
-        tools::time_event performance("kronmult - implicit", ops.flops(imex));
-        ops.template apply<resrc>(imex, -dt * alpha, x_in.data(), beta, y.data());
-        lib_dispatch::axpy<resrc>(y.size(), alpha, x_in.data(), 1, y.data(), 1);
-      },
-      fk::vector<P, mem_type::view, resrc>(x), b,
-      [&](fk::vector<P, mem_type::view, resrc> &x_in) -> void {
-        tools::time_event performance("kronmult - preconditioner", pc.size());
-        apply_diagonal_precond(pc, dt, x_in);
-      },
-      restart, max_iter, tolerance);
+  auto matvec = [&](P const alpha, fk::vector<P, mem_type::view, resrc> const x_in,
+                    P const beta, fk::vector<P, mem_type::view, resrc> y) -> void {
+    tools::time_event performance("kronmult - implicit", ops.flops(imex));
+    ops.template apply<resrc>(imex, -dt * alpha, x_in.data(), beta, y.data());
+    lib_dispatch::axpy<resrc>(y.size(), alpha, x_in.data(), 1, y.data(), 1);
+  };
+  auto precond = [&](fk::vector<P, mem_type::view, resrc> &x_in) -> void {
+    apply_precond(ops, dt, x_in);
+  };
+  if constexpr (resrc == resource::host)
+  {
+    if (ops.get_recycle().max_size > 0)
+      return recycled_gmres(matvec, fk::vector<P, mem_type::view>(x), b, precond,
+                            ops.get_recycle(), dt, restart, max_iter, tolerance);
+  }
+  return simple_gmres(matvec, fk::vector<P, mem_type::view, resrc>(x), b,
+                      precond, restart, max_iter, tolerance);
 }
 template<typename P, resource resrc>
 gmres_info<P>
@@ -142,8 +169,6 @@ bicgstab_euler(const P dt, imex_flag imex,
                fk::vector<P, mem_type::owner, resrc> const &b,
                int const max_iter, P const tolerance)
 {
-  auto const &pc = ops.template get_diagonal_preconditioner<resrc>();
-
   return bicgstab(
     [&](P const alpha, fk::vector<P, mem_type::view, resrc> const x_in,
           P const beta, fk::vector<P, mem_type::view, resrc> y) -> void {
@@ -153,8 +178,7 @@ bicgstab_euler(const P dt, imex_flag imex,
       },
       fk::vector<P, mem_type::view, resrc>(x), b,
       [&](fk::vector<P, mem_type::view, resrc> &x_in) -> void {
-        tools::time_event performance("kronmult - preconditioner", pc.size());
-        apply_diagonal_precond(pc, dt, x_in);
+        apply_precond(ops, dt, x_in);
       }, max_iter, tolerance);
 }
 
@@ -320,6 +344,408 @@ simple_gmres(matrix_abstraction mat, fk::vector<P, mem_type::view, resrc> x,
   return gmres_info<P>{outer_res, total_iterations};
 }
 
+/*!
+ * \brief Orthonormalizes the columns of C and applies the same transformation to U
+ *
+ * Modified Gram-Schmidt, the columns of C that are (numerically) linearly
+ * dependent on the previous ones are dropped together with the columns of U,
+ * so that C = A U still holds after the call.
+ */
+template<typename P>
+void orthonormalize_recycle(fk::matrix<P> &U, fk::matrix<P> &C)
+{
+  int const n = C.nrows();
+  int num     = 0;
+  for (int j = 0; j < C.ncols(); j++)
+  {
+    P *const cj = C.data(0, j);
+    P *const uj = U.data(0, j);
+    P const nrm0 = lib_dispatch::nrm2(n, cj, 1);
+    for (int i = 0; i < num; i++)
+    {
+      P const r = lib_dispatch::dot(n, C.data(0, i), 1, cj, 1);
+      lib_dispatch::axpy(n, -r, C.data(0, i), 1, cj, 1);
+      lib_dispatch::axpy(n, -r, U.data(0, i), 1, uj, 1);
+    }
+    P const nrm = lib_dispatch::nrm2(n, cj, 1);
+    if (nrm <= std::numeric_limits<P>::epsilon() * 1.E+3 * nrm0)
+      continue; // drop the column
+    lib_dispatch::scal(n, P{1} / nrm, cj, 1);
+    lib_dispatch::scal(n, P{1} / nrm, uj, 1);
+    if (j != num)
+    {
+      std::copy_n(cj, n, C.data(0, num));
+      std::copy_n(uj, n, U.data(0, num));
+    }
+    ++num;
+  }
+  if (num < C.ncols())
+  {
+    U = fk::matrix<P>(U.extract_submatrix(0, 0, n, num));
+    C = fk::matrix<P>(C.extract_submatrix(0, 0, n, num));
+  }
+}
+
+// QR factorization of a small dense matrix with modified Gram-Schmidt,
+// A is overwritten with Q and R is the upper triangular factor
+template<typename P>
+void small_qr(fk::matrix<P> &A, fk::matrix<P> &R)
+{
+  int const rows = A.nrows();
+  int const cols = A.ncols();
+  R = fk::matrix<P>(cols, cols);
+  for (int j = 0; j < cols; j++)
+  {
+    for (int i = 0; i < j; i++)
+    {
+      R(i, j) = lib_dispatch::dot(rows, A.data(0, i), 1, A.data(0, j), 1);
+      lib_dispatch::axpy(rows, -R(i, j), A.data(0, i), 1, A.data(0, j), 1);
+    }
+    R(j, j) = lib_dispatch::nrm2(rows, A.data(0, j), 1);
+    if (R(j, j) > 0)
+      lib_dispatch::scal(rows, P{1} / R(j, j), A.data(0, j), 1);
+  }
+}
+
+/*!
+ * \brief Replaces the recycled space after a GCRO-DR cycle
+ *
+ * The cycle used k recycled vectors and j Arnoldi steps, W = [U D, V_j]
+ * and A W = [C, V_{j+1}] G, where D scales the columns of U to unit norm,
+ * G = [D, B; 0, H] with B = C^T A V_j and H the Hessenberg matrix.
+ * The new space is spanned by the harmonic Ritz vectors W z with the
+ * smallest harmonic Ritz values, i.e., G^T G z = theta G^T [C, V_{j+1}]^T W z,
+ * which approximate the eigenvectors that slow down the convergence.
+ */
+template<typename P>
+void update_recycle(krylov_recycle<P> &recycle, int max_recycle, int j,
+                    fk::matrix<P> const &basis, fk::matrix<P> const &hess,
+                    fk::matrix<P> const &proj_c)
+{
+  int const n  = basis.nrows();
+  int const k  = recycle.size();
+  int const s  = k + j;
+  int const kk = std::min(max_recycle, s);
+
+  std::vector<P> dk(k);
+  fk::matrix<P> G(s + 1, s);
+  for (int i = 0; i < k; i++)
+  {
+    dk[i]   = P{1} / lib_dispatch::nrm2(n, recycle.U.data(0, i), 1);
+    G(i, i) = dk[i];
+  }
+  for (int c = 0; c < j; c++)
+  {
+    for (int i = 0; i < k; i++)
+      G(i, k + c) = proj_c(i, c);
+    for (int r = 0; r <= c + 1; r++)
+      G(k + r, k + c) = hess(r, c);
+  }
+
+  fk::matrix<P> Pk(s, kk);
+  if (s == kk)
+  {
+    for (int i = 0; i < s; i++)
+      Pk(i, i) = 1;
+  }
+  else
+  {
+    // VW = [C, V_{j+1}]^T W
+    fk::matrix<P> VW(s + 1, s);
+    if (k > 0)
+    {
+      lib_dispatch::gemm('T', 'N', k, k, n, P{1}, recycle.C.data(), n,
+                         recycle.U.data(), n, P{0}, VW.data(), s + 1);
+      lib_dispatch::gemm('T', 'N', j + 1, k, n, P{1}, basis.data(), n,
+                         recycle.U.data(), n, P{0}, VW.data(k, 0), s + 1);
+      for (int c = 0; c < k; c++)
+        for (int r = 0; r < s + 1; r++)
+          VW(r, c) *= dk[c];
+    }
+    for (int c = 0; c < j; c++)
+      VW(k + c, k + c) = 1;
+
+    // with G = Q R, the problem is R z = theta Q^T VW z
+    // and the smallest |theta| are the largest eigenvalues of R^{-1} Q^T VW
+    fk::matrix<P> Q(G), R;
+    small_qr(Q, R);
+    for (int i = 0; i < s; i++)
+      if (std::abs(R(i, i)) <= std::numeric_limits<P>::epsilon() * std::abs(R(0, 0)))
+        return; // G is rank deficient, keep the old space
+    fk::matrix<P> M(s, s);
+    lib_dispatch::gemm('T', 'N', s, s, s + 1, P{1}, Q.data(), s + 1, VW.data(),
+                       s + 1, P{0}, M.data(), s);
+    for (int c = 0; c < s; c++)
+      for (int r = s - 1; r >= 0; r--)
+      {
+        P sum = M(r, c);
+        for (int i = r + 1; i < s; i++)
+          sum -= R(r, i) * M(i, c);
+        M(r, c) = sum / R(r, r);
+      }
+
+    std::vector<P> wr(s), wi(s);
+    fk::matrix<P> vr(s, s);
+    if (lib_dispatch::geev('N', 'V', s, M.data(), s, wr.data(), wi.data(),
+                           static_cast<P *>(nullptr), 1, vr.data(), s) != 0)
+      return; // the eigensolver failed, keep the old space
+
+    std::vector<int> order(s);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) -> bool {
+      return std::hypot(wr[a], wi[a]) > std::hypot(wr[b], wi[b]);
+    });
+    // complex pairs are stored as real and imaginary parts in two columns
+    std::vector<bool> used(s, false);
+    int num = 0;
+    for (int i = 0; i < s and num < kk; i++)
+    {
+      int const e = (wi[order[i]] < 0) ? order[i] - 1 : order[i];
+      if (used[e])
+        continue;
+      used[e] = true;
+      std::copy_n(vr.data(0, e), s, Pk.data(0, num++));
+      if (wi[e] > 0 and num < kk)
+        std::copy_n(vr.data(0, e + 1), s, Pk.data(0, num++));
+    }
+  }
+
+  // with G Pk = Q2 R2, the new U = W Pk R2^{-1} and C = [C, V_{j+1}] Q2
+  fk::matrix<P> Q2(s + 1, kk), R2;
+  lib_dispatch::gemm('N', 'N', s + 1, kk, s, P{1}, G.data(), s + 1, Pk.data(), s,
+                     P{0}, Q2.data(), s + 1);
+  small_qr(Q2, R2);
+  for (int c = 0; c < kk; c++)
+    if (std::abs(R2(c, c)) <= std::numeric_limits<P>::epsilon() * std::abs(R2(0, 0)))
+      return; // the new vectors are linearly dependent, keep the old space
+
+  fk::matrix<P> U(n, kk), C(n, kk);
+  if (k > 0)
+  {
+    for (int c = 0; c < kk; c++)
+      for (int i = 0; i < k; i++)
+        Pk(i, c) *= dk[i];
+    lib_dispatch::gemm('N', 'N', n, kk, k, P{1}, recycle.U.data(), n, Pk.data(), s,
+                       P{0}, U.data(), n);
+    lib_dispatch::gemm('N', 'N', n, kk, k, P{1}, recycle.C.data(), n, Q2.data(), s + 1,
+                       P{0}, C.data(), n);
+  }
+  lib_dispatch::gemm('N', 'N', n, kk, j, P{1}, basis.data(), n, Pk.data(k, 0), s,
+                     P{1}, U.data(), n);
+  lib_dispatch::gemm('N', 'N', n, kk, j + 1, P{1}, basis.data(), n, Q2.data(k, 0),
+                     s + 1, P{1}, C.data(), n);
+  for (int c = 0; c < kk; c++)
+  {
+    for (int i = 0; i < c; i++)
+      lib_dispatch::axpy(n, -R2(i, c), U.data(0, i), 1, U.data(0, c), 1);
+    lib_dispatch::scal(n, P{1} / R2(c, c), U.data(0, c), 1);
+  }
+
+  recycle.U = std::move(U);
+  recycle.C = std::move(C);
+  // clean up the round-off in the orthogonality of C
+  orthonormalize_recycle(recycle.U, recycle.C);
+}
+
+// GMRES with a recycled subspace (GCRO-DR), host only
+// the recycled space is kept between calls, see krylov_recycle
+template<typename P, typename matrix_abstraction,
+         typename preconditioner_abstraction>
+gmres_info<P>
+recycled_gmres(matrix_abstraction mat, fk::vector<P, mem_type::view> x,
+               fk::vector<P> const &b, preconditioner_abstraction precondition,
+               krylov_recycle<P> &recycle, P const dt, int restart,
+               int max_outer_iterations, P tolerance)
+{
+  if (tolerance == parser::NO_USER_VALUE_FP)
+    tolerance = std::is_same_v<float, P> ? 1e-6 : 1e-12;
+  expect(tolerance >= std::numeric_limits<P>::epsilon());
+
+  int const n = b.size();
+  expect(n == x.size());
+
+  if (restart == parser::NO_USER_VALUE)
+    restart = default_gmres_restarts<P>(n);
+  expect(restart > 0); // checked in program_options
+  if (restart > n)
+  {
+    std::ostringstream err_msg;
+    err_msg << "Number of inner iterations " << restart << " must be less than "
+            << n << "!";
+    throw std::invalid_argument(err_msg.str());
+  }
+
+  if (max_outer_iterations == parser::NO_USER_VALUE)
+    max_outer_iterations = n;
+  expect(max_outer_iterations > 0); // checked in program_options
+
+  // leave room for at least one Arnoldi step per cycle
+  int const max_recycle = std::min(recycle.max_size, restart - 1);
+
+  auto column = [n](fk::matrix<P> &A, int j) -> fk::vector<P, mem_type::view> {
+    return fk::vector<P, mem_type::view>(A, j, 0, n - 1);
+  };
+  // the preconditioned operator
+  auto apply_op = [&](fk::vector<P, mem_type::view> const x_in,
+                      fk::vector<P, mem_type::view> y) -> void {
+    mat(P{1.}, x_in, P{0.}, y);
+    precondition(y);
+  };
+
+  int total_iterations = 0;
+
+  // the grid changed, the old vectors cannot be used
+  if (recycle.U.nrows() != n)
+    recycle.clear();
+  // the operator changed, compute C = A U and make C orthonormal
+  if (recycle.size() > 0 and (recycle.stale or recycle.dt != dt))
+  {
+    recycle.C = fk::matrix<P>(n, recycle.size());
+    for (int j = 0; j < recycle.size(); j++)
+    {
+      apply_op(column(recycle.U, j), column(recycle.C, j));
+      ++total_iterations;
+    }
+    orthonormalize_recycle(recycle.U, recycle.C);
+  }
+  recycle.stale = false;
+  recycle.dt    = dt;
+
+  int const refresh_products = total_iterations;
+  int const num_recycled     = recycle.size();
+
+  // controls how often the inner residual print occurs
+  int const print_freq = std::max(1, restart / 3);
+
+  fk::matrix<P> basis(n, restart + 1);
+  fk::vector<P> krylov_proj(restart * (restart + 1) / 2);
+  fk::vector<P> sines(restart + 1);
+  fk::vector<P> cosines(restart + 1);
+  fk::vector<P> krylov_sol(restart + 1);
+  // the Hessenberg matrix before the Givens rotations and B = C^T A V
+  fk::matrix<P> hess(restart + 1, restart);
+  fk::matrix<P> proj_c(std::max(max_recycle, 1), restart);
+  fk::vector<P> ctr(std::max(max_recycle, 1));
+
+  int outer_iterations = 0;
+  int inner_iterations = 0;
+
+  P inner_res = 0.;
+  P outer_res = tolerance + 1.;
+  while ((outer_res > tolerance) && (outer_iterations < max_outer_iterations))
+  {
+    int const k = recycle.size();
+    // the recycled vectors take the place of Arnoldi steps
+    int const m = restart - k;
+
+    fk::vector<P, mem_type::view> scaled = column(basis, 0);
+    scaled = b;
+    mat(P{-1.}, x, P{1.}, scaled);
+    precondition(scaled);
+    ++total_iterations;
+
+    if (k > 0)
+    { // x += U C^T r and r -= C C^T r
+      lib_dispatch::gemv('T', n, k, P{1}, recycle.C.data(), n, scaled.data(), 1,
+                         P{0}, ctr.data(), 1);
+      lib_dispatch::gemv('N', n, k, P{1}, recycle.U.data(), n, ctr.data(), 1,
+                         P{1}, x.data(), 1);
+      lib_dispatch::gemv('N', n, k, P{-1}, recycle.C.data(), n, ctr.data(), 1,
+                         P{1}, scaled.data(), 1);
+    }
+
+    inner_res = fm::nrm2(scaled);
+    scaled.scale(P{1.} / inner_res);
+    krylov_sol[0] = inner_res;
+
+    inner_iterations = 0;
+    while ((inner_res > tolerance) && (inner_iterations < m))
+    {
+      fk::vector<P, mem_type::view> const tmp = column(basis, inner_iterations);
+      fk::vector<P, mem_type::view> new_basis = column(basis, inner_iterations + 1);
+      apply_op(tmp, new_basis);
+      ++total_iterations;
+      if (k > 0)
+      { // Arnoldi for (I - C C^T) A
+        lib_dispatch::gemv('T', n, k, P{1}, recycle.C.data(), n, new_basis.data(), 1,
+                           P{0}, proj_c.data(0, inner_iterations), 1);
+        lib_dispatch::gemv('N', n, k, P{-1}, recycle.C.data(), n,
+                           proj_c.data(0, inner_iterations), 1, P{1},
+                           new_basis.data(), 1);
+      }
+      fk::matrix<P, mem_type::const_view> basis_v(basis, 0, n - 1, 0,
+                                                  inner_iterations);
+      fk::vector<P, mem_type::view> coeffs(
+          krylov_proj, pos_from_indices(0, inner_iterations),
+          pos_from_indices(inner_iterations, inner_iterations));
+      fm::gemv(basis_v, new_basis, coeffs, true, P{1.}, P{0.});
+      fm::gemv(basis_v, coeffs, new_basis, false, P{-1.}, P{1.});
+      P const nrm = fm::nrm2(new_basis);
+      new_basis.scale(P{1.} / nrm);
+
+      std::copy_n(coeffs.data(), inner_iterations + 1, hess.data(0, inner_iterations));
+      hess(inner_iterations + 1, inner_iterations) = nrm;
+
+      for (int i = 0; i < inner_iterations; ++i)
+      {
+        lib_dispatch::rot(1, coeffs.data(i), 1, coeffs.data(i + 1), 1,
+                          cosines[i], sines[i]);
+      }
+
+      // compute given's rotation
+      P beta = nrm;
+      lib_dispatch::rotg(coeffs.data(inner_iterations), &beta,
+                         cosines.data(inner_iterations),
+                         sines.data(inner_iterations));
+
+      inner_res =
+          std::abs(sines[inner_iterations] * krylov_sol[inner_iterations]);
+
+      if ((inner_res > tolerance) && (inner_iterations < m))
+      {
+        krylov_sol[inner_iterations + 1] = 0.;
+        lib_dispatch::rot(1, krylov_sol.data(inner_iterations), 1,
+                          krylov_sol.data(inner_iterations + 1), 1,
+                          cosines[inner_iterations], sines[inner_iterations]);
+      }
+
+      if (inner_iterations % print_freq == 0)
+      {
+        std::cout << "   -- GMRES inner iteration " << inner_iterations << " / "
+                  << m << " w/ residual " << inner_res << std::endl;
+      }
+      ++inner_iterations;
+    } // end of inner iteration loop
+
+    if (inner_iterations > 0)
+    {
+      auto proj = fk::vector<P, mem_type::view>(
+          krylov_proj, 0,
+          pos_from_indices(inner_iterations - 1, inner_iterations - 1));
+      auto s_view =
+          fk::vector<P, mem_type::view>(krylov_sol, 0, inner_iterations - 1);
+      fm::tpsv(proj, s_view);
+      // x += V y - U B y
+      fk::matrix<P, mem_type::view> v(basis, 0, n - 1, 0, inner_iterations - 1);
+      fm::gemv(v, s_view, x, false, P{1.}, P{1.});
+      if (k > 0)
+      {
+        lib_dispatch::gemv('N', k, inner_iterations, P{1}, proj_c.data(),
+                           proj_c.nrows(), s_view.data(), 1, P{0}, ctr.data(), 1);
+        lib_dispatch::gemv('N', n, k, P{-1}, recycle.U.data(), n, ctr.data(), 1,
+                           P{1}, x.data(), 1);
+      }
+      update_recycle(recycle, max_recycle, inner_iterations, basis, hess, proj_c);
+    }
+    ++outer_iterations;
+    outer_res = inner_res;
+  } // end outer iteration
+  std::cout << "GMRES complete with error: " << outer_res << '\n';
+  std::cout << total_iterations << " iterations, " << num_recycled
+            << " recycled vectors (" << refresh_products << " products to update them)\n";
+  return gmres_info<P>{outer_res, total_iterations, num_recycled, refresh_products};
+}
+
 //*****************************************************************
 // Iterative template routine -- BiCGSTAB
 //
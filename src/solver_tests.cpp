@@ -350,6 +350,312 @@ TEMPLATE_TEST_CASE("test kronmult w/ decompose", "[kronmult]", test_precs)
   }
 }
 
+template<typename P>
+void test_block_jacobi(PDE_opts const pde_choice, fk::vector<int> const &levels,
+                       int const degree)
+{
+  auto make_parser = [&](std::string const &precond) -> parser {
+    parser parse(pde_choice, levels, degree);
+    parser_mod::set(parse, parser_mod::use_implicit_stepping, true);
+    parser_mod::set(parse, parser_mod::solver_str, "gmres");
+    parser_mod::set(parse, parser_mod::kron_backend_str, "block");
+    parser_mod::set(parse, parser_mod::precond_str, precond);
+    // large enough time step, so that I - dt * A is far from diagonal
+    parser_mod::set(parse, parser_mod::dt, 0.01);
+    return parse;
+  };
+  parser const parse_jacobi = make_parser("jacobi");
+  parser const parse_block  = make_parser("block-jacobi");
+
+  auto pde = make_PDE<P>(parse_block);
+  options const opts_jacobi(parse_jacobi);
+  options const opts_block(parse_block);
+  basis::wavelet_transform<P, resource::host> const transformer(opts_block, *pde);
+  generate_all_coefficients(*pde, transformer);
+
+  elements::table const table(opts_block, *pde);
+  element_subgrid const my_subgrid(0, table.size() - 1, 0, table.size() - 1);
+
+  int const block_size  = static_cast<int>(std::pow(degree, pde->num_dims()));
+  int const system_size = block_size * table.size();
+  P const dt            = pde->get_dt();
+
+  // AA = I - dt*A;
+  fk::matrix<P> A(system_size, system_size);
+  build_system_matrix(*pde, table, A, my_subgrid);
+  fm::scal(P{-1.} * dt, A);
+  for (int i = 0; i < A.nrows(); ++i)
+    A(i, i) += 1.0;
+
+  std::minstd_rand park_miller(42);
+  std::uniform_real_distribution<P> unif(-1.0, 1.0);
+  fk::vector<P> b(system_size);
+  for (auto &v : b)
+    v = unif(park_miller);
+
+  asgard::adapt::distributed_grid adaptive_grid(*pde, opts_block);
+
+  kron_operators<P> ops_jacobi, ops_block;
+  ops_jacobi.make(imex_flag::unspecified, *pde, adaptive_grid, opts_jacobi);
+  ops_block.make(imex_flag::unspecified, *pde, adaptive_grid, opts_block);
+
+  REQUIRE(not ops_jacobi.has_block_preconditioner());
+  REQUIRE(ops_block.has_block_preconditioner());
+
+  // the preconditioner solves with the diagonal blocks of I - dt * A
+  fk::vector<P> gold(b);
+  for (int c = 0; c < table.size(); c++)
+  {
+    fk::matrix<P> block = A.extract_submatrix(c * block_size, c * block_size,
+                                              block_size, block_size);
+    fk::vector<P, mem_type::view> gc(gold, c * block_size, (c + 1) * block_size - 1);
+    std::vector<int> ipiv(block_size);
+    fm::gesv(block, gc, ipiv);
+  }
+  fk::vector<P> x(b);
+  ops_block.apply_block_preconditioner(dt, x.data());
+  rmse_comparison(gold, x, get_tolerance<P>(100));
+
+  // the preconditioned solver converges to the same solution in fewer iterations
+  std::vector<int> ipiv(A.nrows());
+  fk::matrix<P> LU(A);
+  gold = b;
+  fm::gesv(LU, gold, ipiv);
+
+  int const restart  = parser::DEFAULT_GMRES_INNER_ITERATIONS;
+  int const max_iter = parser::DEFAULT_GMRES_OUTER_ITERATIONS;
+  P const tolerance  = std::is_same_v<float, P> ? 1e-6 : 1e-12;
+
+  fk::vector<P> x_jacobi(system_size), x_block(system_size);
+  gmres_info<P> const info_jacobi = solver::simple_gmres_euler(
+      dt, imex_flag::unspecified, ops_jacobi, x_jacobi, b, restart, max_iter, tolerance);
+  gmres_info<P> const info_block = solver::simple_gmres_euler(
+      dt, imex_flag::unspecified, ops_block, x_block, b, restart, max_iter, tolerance);
+
+  // the solver tolerance is on the preconditioned residual
+  P const solution_tol = std::is_same_v<float, P> ? 1e-4 : 1e-9;
+  rmse_comparison(gold, x_jacobi, solution_tol);
+  rmse_comparison(gold, x_block, solution_tol);
+  REQUIRE(info_block.iterations < info_jacobi.iterations);
+
+  parameter_manager<P>::get_instance().reset();
+}
+
+TEMPLATE_TEST_CASE("block-jacobi preconditioner", "[solver]", test_precs)
+{
+  SECTION("2d diffusion")
+  {
+    test_block_jacobi<TestType>(PDE_opts::diffusion_2, {4, 4}, 3);
+  }
+  SECTION("2d fokker-planck")
+  {
+    test_block_jacobi<TestType>(PDE_opts::fokkerplanck_2d_complete_case4, {3, 3}, 2);
+  }
+}
+
+template<typename P>
+void test_multilevel(PDE_opts const pde_choice, fk::vector<int> const &levels,
+                     int const degree)
+{
+  auto make_parser = [&](std::string const &precond) -> parser {
+    parser parse(pde_choice, levels, degree);
+    parser_mod::set(parse, parser_mod::use_implicit_stepping, true);
+    parser_mod::set(parse, parser_mod::solver_str, "gmres");
+    parser_mod::set(parse, parser_mod::kron_backend_str, "block");
+    parser_mod::set(parse, parser_mod::precond_str, precond);
+    parser_mod::set(parse, parser_mod::dt, 0.01);
+    return parse;
+  };
+  parser const parse_jacobi = make_parser("jacobi");
+  parser const parse_multi  = make_parser("multilevel");
+
+  auto pde = make_PDE<P>(parse_multi);
+  options const opts_jacobi(parse_jacobi);
+  options const opts_multi(parse_multi);
+  basis::wavelet_transform<P, resource::host> const transformer(opts_multi, *pde);
+  generate_all_coefficients(*pde, transformer);
+
+  elements::table const table(opts_multi, *pde);
+  element_subgrid const my_subgrid(0, table.size() - 1, 0, table.size() - 1);
+
+  int const block_size  = static_cast<int>(std::pow(degree, pde->num_dims()));
+  int const system_size = block_size * table.size();
+  P const dt            = pde->get_dt();
+
+  // AA = I - dt*A;
+  fk::matrix<P> A(system_size, system_size);
+  build_system_matrix(*pde, table, A, my_subgrid);
+  fm::scal(P{-1.} * dt, A);
+  for (int i = 0; i < A.nrows(); ++i)
+    A(i, i) += 1.0;
+
+  std::minstd_rand park_miller(42);
+  std::uniform_real_distribution<P> unif(-1.0, 1.0);
+  fk::vector<P> b(system_size);
+  for (auto &v : b)
+    v = unif(park_miller);
+
+  std::vector<int> ipiv(A.nrows());
+  fk::vector<P> gold(b);
+  fm::gesv(A, gold, ipiv);
+
+  asgard::adapt::distributed_grid adaptive_grid(*pde, opts_multi);
+
+  kron_operators<P> ops_jacobi, ops_multi;
+  ops_jacobi.make(imex_flag::unspecified, *pde, adaptive_grid, opts_jacobi);
+  ops_multi.make(imex_flag::unspecified, *pde, adaptive_grid, opts_multi);
+
+  REQUIRE(not ops_jacobi.has_multilevel_preconditioner());
+  REQUIRE(ops_multi.has_multilevel_preconditioner());
+
+  int const restart  = parser::DEFAULT_GMRES_INNER_ITERATIONS;
+  int const max_iter = parser::DEFAULT_GMRES_OUTER_ITERATIONS;
+  P const tolerance  = std::is_same_v<float, P> ? 1e-6 : 1e-12;
+
+  fk::vector<P> x_jacobi(system_size), x_multi(system_size);
+  gmres_info<P> const info_jacobi = solver::simple_gmres_euler(
+      dt, imex_flag::unspecified, ops_jacobi, x_jacobi, b, restart, max_iter, tolerance);
+  gmres_info<P> const info_multi = solver::simple_gmres_euler(
+      dt, imex_flag::unspecified, ops_multi, x_multi, b, restart, max_iter, tolerance);
+
+  // the solver tolerance is on the preconditioned residual
+  P const solution_tol = std::is_same_v<float, P> ? 1e-4 : 1e-9;
+  rmse_comparison(gold, x_jacobi, solution_tol);
+  rmse_comparison(gold, x_multi, solution_tol);
+  REQUIRE(info_multi.iterations < info_jacobi.iterations);
+
+  parameter_manager<P>::get_instance().reset();
+}
+
+TEMPLATE_TEST_CASE("multilevel preconditioner", "[solver]", test_precs)
+{
+  SECTION("2d diffusion, two levels")
+  {
+    test_multilevel<TestType>(PDE_opts::diffusion_2, {6, 6}, 2);
+  }
+  SECTION("2d diffusion, three levels")
+  {
+    test_multilevel<TestType>(PDE_opts::diffusion_2, {7, 7}, 2);
+  }
+}
+
+template<typename P>
+void test_gmres_recycle(PDE_opts const pde_choice, fk::vector<int> const &levels,
+                        int const degree)
+{
+  int const restart = 20;
+  auto make_parser = [&](int recycle) -> parser {
+    parser parse(pde_choice, levels, degree);
+    parser_mod::set(parse, parser_mod::use_implicit_stepping, true);
+    parser_mod::set(parse, parser_mod::solver_str, "gmres");
+    parser_mod::set(parse, parser_mod::gmres_inner_iterations, restart);
+    parser_mod::set(parse, parser_mod::gmres_recycle, recycle);
+    parser_mod::set(parse, parser_mod::dt, 0.01);
+    return parse;
+  };
+  parser const parse_plain   = make_parser(0);
+  parser const parse_recycle = make_parser(8);
+
+  auto pde = make_PDE<P>(parse_recycle);
+  options const opts_plain(parse_plain);
+  options const opts_recycle(parse_recycle);
+  basis::wavelet_transform<P, resource::host> const transformer(opts_recycle, *pde);
+  generate_all_coefficients(*pde, transformer);
+
+  elements::table const table(opts_recycle, *pde);
+  element_subgrid const my_subgrid(0, table.size() - 1, 0, table.size() - 1);
+
+  int const block_size  = static_cast<int>(std::pow(degree, pde->num_dims()));
+  int const system_size = block_size * table.size();
+  P const dt            = pde->get_dt();
+
+  // LU of I - dt*A for the reference solutions
+  fk::matrix<P> A(system_size, system_size);
+  build_system_matrix(*pde, table, A, my_subgrid);
+  fm::scal(P{-1.} * dt, A);
+  for (int i = 0; i < A.nrows(); ++i)
+    A(i, i) += 1.0;
+  std::vector<int> ipiv(A.nrows());
+  fm::getrf(A, ipiv);
+
+  asgard::adapt::distributed_grid adaptive_grid(*pde, opts_recycle);
+
+  kron_operators<P> ops_plain, ops_recycle;
+  ops_plain.make(imex_flag::unspecified, *pde, adaptive_grid, opts_plain);
+  ops_recycle.make(imex_flag::unspecified, *pde, adaptive_grid, opts_recycle);
+
+  REQUIRE(ops_plain.get_recycle().max_size == 0);
+  REQUIRE(ops_recycle.get_recycle().max_size == 8);
+
+  int const max_iter = parser::DEFAULT_GMRES_OUTER_ITERATIONS;
+  P const tolerance  = std::is_same_v<float, P> ? 1e-6 : 1e-12;
+  // the solver tolerance is on the preconditioned residual
+  P const solution_tol = std::is_same_v<float, P> ? 1e-4 : 1e-9;
+
+  std::minstd_rand park_miller(42);
+  std::uniform_real_distribution<P> unif(-1.0, 1.0);
+  auto solve = [&](kron_operators<P> const &ops, fk::vector<P> const &b)
+      -> gmres_info<P> {
+    fk::vector<P> x(system_size);
+    gmres_info<P> const info = solver::simple_gmres_euler(
+        dt, imex_flag::unspecified, ops, x, b, restart, max_iter, tolerance);
+    fk::vector<P> gold(b);
+    fm::getrs(A, gold, ipiv);
+    rmse_comparison(gold, x, solution_tol);
+    return info;
+  };
+
+  // sequence of right-hand-sides, as in time stepping
+  int iter_plain = 0, iter_recycle = 0;
+  for (int r = 0; r < 4; r++)
+  {
+    fk::vector<P> b(system_size);
+    for (auto &v : b)
+      v = unif(park_miller);
+
+    gmres_info<P> const info_plain   = solve(ops_plain, b);
+    gmres_info<P> const info_recycle = solve(ops_recycle, b);
+    REQUIRE(info_plain.recycled == 0);
+    if (r == 0)
+    {
+      REQUIRE(info_recycle.recycled == 0);
+    }
+    else
+    {
+      REQUIRE(info_recycle.recycled > 0);
+      iter_plain += info_plain.iterations;
+      iter_recycle += info_recycle.iterations;
+    }
+  }
+  REQUIRE(iter_recycle < iter_plain);
+
+  // new coefficients, C = A U is recomputed with k products
+  int const k = ops_recycle.get_recycle().size();
+  REQUIRE(k > 0);
+  ops_recycle.get_recycle().stale = true;
+  fk::vector<P> b(system_size);
+  for (auto &v : b)
+    v = unif(park_miller);
+  gmres_info<P> const info = solve(ops_recycle, b);
+  REQUIRE(info.recycle_products == k);
+  REQUIRE(info.recycled <= k);
+
+  // the matrices are remade after the grid changes, the space is discarded
+  ops_recycle.clear();
+  REQUIRE(ops_recycle.get_recycle().size() == 0);
+  REQUIRE(ops_recycle.get_recycle().max_size == 8);
+
+  parameter_manager<P>::get_instance().reset();
+}
+
+TEMPLATE_TEST_CASE("gmres recycling", "[solver]", test_precs)
+{
+  SECTION("2d diffusion")
+  {
+    test_gmres_recycle<TestType>(PDE_opts::diffusion_2, {4, 4}, 3);
+  }
+}
+
 TEMPLATE_TEST_CASE("poisson setup and solve", "[solver]", test_precs)
 {
   SECTION("simple test case")
@@ -39,6 +39,79 @@ get_sources(PDE<P> const &pde, adapt::distributed_grid<P> const &grid,
   return sources;
 }
 
+// improves the initial guess x for the implicit solve (I - dt * A) x = b
+// using the solutions of the previous steps stored in the history of the stage
+// the guess is extrapolated from the history and x is replaced by the
+// combination of x and the extrapolated guess that minimizes the residual,
+// i.e., the guess is never worse than the original one at the cost of two products
+template<typename P, resource resrc>
+static void
+improve_guess(kron_operators<P> &operator_matrices, imex_flag const imex,
+              int const stage, elements::table const &table, P const time,
+              P const dt, fk::vector<P, mem_type::owner, resrc> const &b,
+              fk::vector<P, mem_type::owner, resrc> &x)
+{
+  auto &history = operator_matrices.get_history(stage);
+  if (history.size() == 0)
+    return;
+  tools::time_event performance("extrapolate initial guess");
+
+  int const n = x.size();
+  fk::vector<P, mem_type::owner, resrc> xe(n);
+  if constexpr (resrc == resource::host)
+  {
+    history.extrapolate(table, time, xe);
+  }
+  else
+  {
+    fk::vector<P> xe_h(n);
+    history.extrapolate(table, time, xe_h);
+    xe = xe_h.clone_onto_device();
+  }
+
+  // ax = (I - dt * A) x and ae = (I - dt * A) xe
+  fk::vector<P, mem_type::owner, resrc> ax(n), ae(n);
+  operator_matrices.template apply<resrc>(imex, -dt, x.data(), 0, ax.data());
+  lib_dispatch::axpy<resrc>(n, P{1}, x.data(), 1, ax.data(), 1);
+  operator_matrices.template apply<resrc>(imex, -dt, xe.data(), 0, ae.data());
+  lib_dispatch::axpy<resrc>(n, P{1}, xe.data(), 1, ae.data(), 1);
+
+  // min || b - c0 * ax - c1 * ae ||, from the 2 by 2 normal equations
+  P const g00 = lib_dispatch::dot<resrc>(n, ax.data(), 1, ax.data(), 1);
+  P const g01 = lib_dispatch::dot<resrc>(n, ax.data(), 1, ae.data(), 1);
+  P const g11 = lib_dispatch::dot<resrc>(n, ae.data(), 1, ae.data(), 1);
+  P const r0  = lib_dispatch::dot<resrc>(n, ax.data(), 1, b.data(), 1);
+  P const r1  = lib_dispatch::dot<resrc>(n, ae.data(), 1, b.data(), 1);
+
+  P const det = g00 * g11 - g01 * g01;
+  if (det <= std::numeric_limits<P>::epsilon() * g00 * g11)
+  { // the guesses are (almost) parallel, pick the better one
+    if (g11 > 0 && r1 * r1 / g11 > ((g00 > 0) ? r0 * r0 / g00 : P{0}))
+    {
+      lib_dispatch::scal<resrc>(n, r1 / g11, xe.data(), 1);
+      x = std::move(xe);
+    }
+    return;
+  }
+  P const c0 = (g11 * r0 - g01 * r1) / det;
+  P const c1 = (g00 * r1 - g01 * r0) / det;
+  lib_dispatch::scal<resrc>(n, c0, x.data(), 1);
+  lib_dispatch::axpy<resrc>(n, c1, xe.data(), 1, x.data(), 1);
+}
+// records the solution of the implicit solve in the history
+template<typename P, resource resrc>
+static void
+record_solution(solution_history<P> &history, elements::table const &table,
+                P const time, fk::vector<P, mem_type::owner, resrc> const &x)
+{
+  if (history.max_size == 0)
+    return;
+  if constexpr (resrc == resource::host)
+    history.push(table, time, x);
+  else
+    history.push(table, time, x.clone_onto_host());
+}
+
 // FIXME want to change how sources/bcs are handled
 template<typename P>
 fk::vector<P>
@@ -435,10 +508,13 @@ implicit_advance(PDE<P> &pde, kron_operators<P> &operator_matrices,
     int const restart  = program_opts.gmres_inner_iterations;
     int const max_iter = program_opts.gmres_outer_iterations;
     fk::vector<P> fx(x);
+    improve_guess(operator_matrices, imex_flag::unspecified, 0, table,
+                  time + dt, dt, x, fx);
     // TODO: do something better to save gmres output to pde
     pde.gmres_outputs[0] = solver::simple_gmres_euler<P, resource::host>(
         pde.get_dt(), imex_flag::unspecified, operator_matrices,
         fx, x, restart, max_iter, tolerance);
+    record_solution(operator_matrices.get_history(0), table, time + dt, fx);
     return fx;
   }
   else if (solver == solve_opts::bicgstab)
@@ -448,10 +524,13 @@ implicit_advance(PDE<P> &pde, kron_operators<P> &operator_matrices,
     P const tolerance  = program_opts.gmres_tolerance;
     int const max_iter = program_opts.gmres_outer_iterations;
     fk::vector<P> fx(x);
+    improve_guess(operator_matrices, imex_flag::unspecified, 0, table,
+                  time + dt, dt, x, fx);
     // TODO: do something better to save gmres output to pde
     pde.gmres_outputs[0] = solver::bicgstab_euler<P, resource::host>(
         pde.get_dt(), imex_flag::unspecified, operator_matrices,
         fx, x, max_iter, tolerance);
+    record_solution(operator_matrices.get_history(0), table, time + dt, fx);
     return fx;
   }
   return x;
@@ -839,9 +918,12 @@ imex_advance(PDE<P> &pde, kron_operators<P> &operator_matrices,
                                          adaptive_grid, program_opts);
 
     // use previous refined solution as initial guess to GMRES if it exists
+    // otherwise improve f_1s using the previous steps
     if (x_prev.empty())
     {
       f_1 = f; // use f_1s as input
+      improve_guess(operator_matrices, imex_flag::imex_implicit, 0,
+                    adaptive_grid.get_table(), time + dt, dt, f, f_1);
     }
     else
     {
@@ -870,6 +952,8 @@ imex_advance(PDE<P> &pde, kron_operators<P> &operator_matrices,
     {
       throw std::runtime_error("imex solver must be gmres or bicgstab.");
     }
+    record_solution(operator_matrices.get_history(0), adaptive_grid.get_table(),
+                    time + dt, f_1);
     // save output of GMRES call to use in the second one
     f_1_output = f_1;
   }
@@ -952,6 +1036,9 @@ imex_advance(PDE<P> &pde, kron_operators<P> &operator_matrices,
 
     operator_matrices.reset_coefficients(imex_flag::imex_implicit, pde,
                                          adaptive_grid, program_opts);
+    if (x_prev.empty())
+      improve_guess(operator_matrices, imex_flag::imex_implicit, 1,
+                    adaptive_grid.get_table(), time + dt, P{0.5} * dt, f, f_2);
 
     if (solver == solve_opts::gmres)
     {
@@ -969,6 +1056,8 @@ imex_advance(PDE<P> &pde, kron_operators<P> &operator_matrices,
     {
       throw std::runtime_error("imex solver must be gmres or bicgstab.");
     }
+    record_solution(operator_matrices.get_history(1), adaptive_grid.get_table(),
+                    time + dt, f_2);
     tools::timer.stop("implicit_2_solve");
     tools::timer.stop("implicit_2");
     if constexpr (imex_resrc == resource::device)
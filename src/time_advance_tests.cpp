@@ -672,6 +672,46 @@ TEMPLATE_TEST_CASE("time advance - continuity 3", "[time_advance]", test_precs)
     time_advance_test(parse, gold_base, tol_factor);
   }
 
+  SECTION("continuity3, explicit, level 4, degree 3, sparse grid, morton order")
+  {
+    int const degree     = 3;
+    int const level      = 4;
+    auto const gold_base = time_advance_base_dir / "continuity3_sg_l4_d3_t";
+
+    auto const full_grid = false;
+    parser parse         = make_basic_parser(
+        pde_choice, fk::vector<int>(std::vector<int>(num_dims, level)), degree,
+        cfl, full_grid, num_steps);
+    parser_mod::set(parse, parser_mod::use_morton_order, true);
+
+    time_advance_test(parse, gold_base, tol_factor);
+  }
+
+  SECTION("continuity3, explicit, level 4, degree 3, sparse grid, kron backends")
+  {
+    if (get_num_ranks() > 1) // only the local backend works with mpi
+      return;
+    int const degree     = 3;
+    int const level      = 4;
+    auto const gold_base = time_advance_base_dir / "continuity3_sg_l4_d3_t";
+
+    auto const full_grid = false;
+#ifdef ASGARD_USE_CUDA
+    std::vector<std::string> const backends = {"local", "global", "auto"};
+#else
+    std::vector<std::string> const backends = {"local", "global", "block", "auto"};
+#endif
+    for (auto const &backend : backends)
+    {
+      parser parse = make_basic_parser(
+          pde_choice, fk::vector<int>(std::vector<int>(num_dims, level)), degree,
+          cfl, full_grid, num_steps);
+      parser_mod::set(parse, parser_mod::kron_backend_str, backend);
+
+      time_advance_test(parse, gold_base, tol_factor);
+    }
+  }
+
   SECTION("continuity3, explicit/non-uniform level, degree 4, sparse grid")
   {
     int const degree = 4;
@@ -1972,3 +2012,343 @@ TEMPLATE_TEST_CASE("testing multi imex explicit", "imex_explicit", test_precs)
   test_memory_mode<TestType>(imex_flag::imex_explicit);
 }
 #endif
+
+#ifdef ASGARD_USE_CPU_MEM_LIMIT
+TEMPLATE_TEST_CASE("testing out-of-core local kronmult", "[out-of-core]", test_precs)
+{
+  using prec = TestType;
+  if (get_num_ranks() > 1) // this is a one-rank test
+    return;
+  fk::vector<int> levels = {8, 8};
+  parser parse("two_stream", levels);
+  parser_mod::set(parse, parser_mod::degree, 3);
+
+  auto pde = make_PDE<prec>(parse);
+
+  options const opts(parse);
+
+  adapt::distributed_grid grid(*pde, opts);
+  basis::wavelet_transform<prec, resource::host> const transformer(opts, *pde);
+  generate_dimension_mass_mat(*pde, transformer);
+  generate_all_coefficients(*pde, transformer);
+  auto const x = grid.get_initial_condition(*pde, transformer, opts);
+
+  constexpr bool force_sparse = true;
+  imex_flag const imex        = imex_flag::unspecified;
+
+  kron_sparse_cache spcache_in, spcache_ooc;
+  memory_usage mem_in = compute_mem_usage(*pde, grid, opts, imex, spcache_in,
+                                          0, 2147483646, force_sparse);
+  auto mat_in = make_local_kronmult_matrix(*pde, grid, opts, mem_in, imex,
+                                           spcache_in, force_sparse);
+
+  // leave only 2MB for the indexes, forces at least two chunks in the file
+  memory_usage mem_ooc = compute_mem_usage(
+      *pde, grid, opts, imex, spcache_ooc, mem_in.baseline_memory + 2,
+      2147483646, force_sparse);
+  REQUIRE(mem_ooc.kron_call == memory_usage::multi_calls);
+  REQUIRE(mem_ooc.mem_limit == memory_usage::environment);
+  auto mat_ooc = make_local_kronmult_matrix(*pde, grid, opts, mem_ooc, imex,
+                                            spcache_ooc, force_sparse);
+
+  REQUIRE(mat_in.is_onecall());
+  REQUIRE(not mat_in.is_out_of_core());
+  REQUIRE(mat_ooc.is_out_of_core());
+  REQUIRE(not mat_ooc.is_onecall());
+  REQUIRE(mat_in.flops() == mat_ooc.flops());
+
+  fk::vector<prec> y_in(mat_in.output_size());
+  fk::vector<prec> y_ooc(mat_ooc.output_size());
+  REQUIRE(y_in.size() == y_ooc.size());
+
+  mat_in.apply(2.0, x.data(), 0.0, y_in.data());
+  mat_ooc.apply(2.0, x.data(), 0.0, y_ooc.data());
+  rmse_comparison(y_in, y_ooc, prec{10});
+
+  // repeated calls read the chunks back from the file
+  fk::vector<prec> y2_in(y_in);
+  fk::vector<prec> y2_ooc(y_ooc);
+  mat_in.apply(2.5, y_in.data(), 3.0, y2_in.data());
+  mat_ooc.apply(2.5, y_ooc.data(), 3.0, y2_ooc.data());
+  rmse_comparison(y2_in, y2_ooc, prec{10});
+
+  parameter_manager<prec>::get_instance().reset();
+}
+#endif
+
+#ifndef ASGARD_USE_CUDA
+template<typename prec>
+void test_packed_index(std::string const &pde_name,
+                       fk::vector<int> const &levels, int const degree)
+{
+  parser parse(pde_name, levels);
+  parser_mod::set(parse, parser_mod::degree, degree);
+
+  auto pde = make_PDE<prec>(parse);
+
+  options const opts(parse);
+
+  adapt::distributed_grid grid(*pde, opts);
+  basis::wavelet_transform<prec, resource::host> const transformer(opts, *pde);
+  generate_dimension_mass_mat(*pde, transformer);
+  generate_all_coefficients(*pde, transformer);
+  auto const x = grid.get_initial_condition(*pde, transformer, opts);
+
+  constexpr bool force_sparse = true;
+  imex_flag const imex        = imex_flag::unspecified;
+
+  // the small index limit forces the multi-call mode
+  for (int64_t index_limit : {int64_t{2147483646}, int64_t{4000}})
+  {
+    kron_sparse_cache spcache_full, spcache_packed;
+    memory_usage mem = compute_mem_usage(*pde, grid, opts, imex, spcache_full,
+                                         0, index_limit, force_sparse);
+    REQUIRE(spcache_full.packed_index);
+    spcache_full.packed_index = false;
+    auto mat_full = make_local_kronmult_matrix(*pde, grid, opts, mem, imex,
+                                               spcache_full, force_sparse);
+
+    mem = compute_mem_usage(*pde, grid, opts, imex, spcache_packed, 0,
+                            index_limit, force_sparse);
+    auto mat_packed = make_local_kronmult_matrix(*pde, grid, opts, mem, imex,
+                                                 spcache_packed, force_sparse);
+
+    REQUIRE(not mat_full.is_packed_index());
+    REQUIRE(mat_packed.is_packed_index());
+    REQUIRE(mat_full.is_onecall() == mat_packed.is_onecall());
+    REQUIRE(mat_full.is_onecall() == (index_limit > 4000));
+    REQUIRE(mat_full.flops() == mat_packed.flops());
+
+    fk::vector<prec> y_full(mat_full.output_size());
+    fk::vector<prec> y_packed(mat_packed.output_size());
+
+    mat_full.apply(2.0, x.data(), 0.0, y_full.data());
+    mat_packed.apply(2.0, x.data(), 0.0, y_packed.data());
+    rmse_comparison(y_full, y_packed, prec{10});
+
+    fk::vector<prec> y2_full(y_full);
+    fk::vector<prec> y2_packed(y_packed);
+    mat_full.apply(-1.0, y_full.data(), 3.0, y2_full.data());
+    mat_packed.apply(-1.0, y_packed.data(), 3.0, y2_packed.data());
+    rmse_comparison(y2_full, y2_packed, prec{10});
+  }
+
+  parameter_manager<prec>::get_instance().reset();
+}
+
+TEMPLATE_TEST_CASE("testing packed index local kronmult", "[packed-index]",
+                   test_precs)
+{
+  if (get_num_ranks() > 1) // this is a one-rank test
+    return;
+  SECTION("2d, even number of offsets per pair")
+  {
+    test_packed_index<TestType>("two_stream", {5, 5}, 3);
+  }
+  SECTION("3d, odd number of offsets per pair")
+  {
+    test_packed_index<TestType>("continuity_3", {4, 4, 4}, 2);
+  }
+}
+
+template<typename prec>
+void test_scalar_combined(std::string const &pde_name,
+                          fk::vector<int> const &levels)
+{
+  // the 1MB limit is too small for the dense combined matrix
+  auto make_matrix = [&](bool force_sparse, int memory_limit)
+      -> std::pair<local_kronmult_matrix<prec>, fk::vector<prec>> {
+    parser parse(pde_name, levels);
+    parser_mod::set(parse, parser_mod::degree, 1);
+    parser_mod::set(parse, parser_mod::memory_limit, memory_limit);
+
+    auto pde = make_PDE<prec>(parse);
+
+    options const opts(parse);
+
+    adapt::distributed_grid grid(*pde, opts);
+    basis::wavelet_transform<prec, resource::host> const transformer(opts, *pde);
+    generate_dimension_mass_mat(*pde, transformer);
+    generate_all_coefficients(*pde, transformer);
+    auto x = grid.get_initial_condition(*pde, transformer, opts);
+
+    kron_sparse_cache spcache;
+    memory_usage mem = compute_mem_usage(*pde, grid, opts, imex_flag::unspecified,
+                                         spcache, 8192, 2147483646, force_sparse);
+    auto mat = make_local_kronmult_matrix(*pde, grid, opts, mem,
+                                          imex_flag::unspecified, spcache,
+                                          force_sparse);
+    parameter_manager<prec>::get_instance().reset();
+    return {std::move(mat), std::move(x)};
+  };
+
+  auto [mat_kron, x] = make_matrix(false, 1);
+  auto [mat_dense, x_dense] = make_matrix(false, 8192);
+  auto [mat_sparse, x_sparse] = make_matrix(true, 8192);
+
+  REQUIRE(mat_kron.is_dense());
+  REQUIRE(mat_dense.is_dense());
+  REQUIRE(not mat_sparse.is_dense());
+  REQUIRE(not mat_kron.is_scalar_combined());
+  REQUIRE(mat_dense.is_scalar_combined());
+  REQUIRE(mat_sparse.is_scalar_combined());
+
+  fk::vector<prec> y_kron(mat_kron.output_size());
+  fk::vector<prec> y_dense(mat_dense.output_size());
+  fk::vector<prec> y_sparse(mat_sparse.output_size());
+
+  mat_kron.apply(2.0, x.data(), 0.0, y_kron.data());
+  mat_dense.apply(2.0, x.data(), 0.0, y_dense.data());
+  mat_sparse.apply(2.0, x.data(), 0.0, y_sparse.data());
+  rmse_comparison(y_kron, y_dense, prec{10});
+  rmse_comparison(y_kron, y_sparse, prec{10});
+
+  // the block of vectors goes through gemm, compare against one at a time
+  int constexpr num_rhs = 3;
+  std::vector<fk::vector<prec>> xb = {x, y_kron, x + y_kron};
+  std::vector<fk::vector<prec>> yb_kron = {y_kron, x, y_kron - x};
+  std::vector<fk::vector<prec>> yb_dense = yb_kron;
+  std::vector<fk::vector<prec>> yb_sparse = yb_kron;
+
+  std::vector<prec const *> px(num_rhs);
+  std::vector<prec *> py_dense(num_rhs), py_sparse(num_rhs);
+  for (int v = 0; v < num_rhs; v++)
+  {
+    px[v]        = xb[v].data();
+    py_dense[v]  = yb_dense[v].data();
+    py_sparse[v] = yb_sparse[v].data();
+    mat_kron.apply(-1.5, xb[v].data(), 3.0, yb_kron[v].data());
+  }
+  mat_dense.apply_block(num_rhs, -1.5, px.data(), 3.0, py_dense.data());
+  mat_sparse.apply_block(num_rhs, -1.5, px.data(), 3.0, py_sparse.data());
+  for (int v = 0; v < num_rhs; v++)
+  {
+    rmse_comparison(yb_kron[v], yb_dense[v], prec{10});
+    rmse_comparison(yb_kron[v], yb_sparse[v], prec{10});
+  }
+}
+
+TEMPLATE_TEST_CASE("testing combined scalar local kronmult", "[scalar-combined]",
+                   test_precs)
+{
+  if (get_num_ranks() > 1) // this is a one-rank test
+    return;
+  SECTION("2d, n = 1") { test_scalar_combined<TestType>("two_stream", {7, 7}); }
+  SECTION("3d, n = 1")
+  {
+    test_scalar_combined<TestType>("continuity_3", {6, 6, 6});
+  }
+}
+#endif
+
+template<typename P>
+void test_solution_history()
+{
+  int const degree = 2;
+  auto make_table = [&](fk::vector<int> const &levels) -> elements::table {
+    parser parse("diffusion_2", levels);
+    parser_mod::set(parse, parser_mod::degree, degree);
+    parser_mod::set(parse, parser_mod::max_level, 4);
+    auto pde = make_PDE<P>(parse);
+    options const opts(parse);
+    elements::table table(opts, *pde);
+    parameter_manager<P>::get_instance().reset();
+    return table;
+  };
+  elements::table const coarse = make_table({2, 2});
+  elements::table const fine   = make_table({3, 3});
+
+  int const block_size = degree * degree;
+  int const size       = block_size * coarse.size();
+
+  std::minstd_rand park_miller(42);
+  std::uniform_real_distribution<P> unif(-1.0, 1.0);
+  fk::vector<P> u(size), v(size), w(size);
+  for (auto *z : {&u, &v, &w})
+    for (auto &e : *z)
+      e = unif(park_miller);
+  // quadratic in time, extrapolated exactly from the last three solutions
+  auto exact = [&](P t) -> fk::vector<P> { return u + v * t + w * (t * t); };
+
+  solution_history<P> history;
+  history.max_size = 3;
+  fk::vector<P> x(size);
+  REQUIRE(not history.extrapolate(coarse, 0.1, x));
+  for (int i = 1; i <= 4; i++)
+    history.push(coarse, P(0.1) * i, exact(P(0.1) * i));
+  REQUIRE(history.size() == 3);
+  // repeated step, the last solution is replaced
+  history.push(coarse, P(0.4), exact(P(0.4)));
+  REQUIRE(history.size() == 3);
+
+  REQUIRE(history.extrapolate(coarse, 0.5, x));
+  rmse_comparison(exact(0.5), x, get_tolerance<P>(100));
+
+  // after refinement, the old cells keep the values and the new ones are zero
+  fk::vector<P> xfine(block_size * fine.size());
+  REQUIRE(history.extrapolate(fine, 0.5, xfine));
+  fk::vector<P> gold(xfine.size());
+  for (int64_t i = 0; i < fine.size(); i++)
+    for (int64_t j = 0; j < coarse.size(); j++)
+      if (fine.get_element_id(i) == coarse.get_element_id(j))
+        std::copy_n(x.data() + j * block_size, block_size,
+                    gold.data() + i * block_size);
+  rmse_comparison(gold, xfine, get_tolerance<P>(100));
+
+  history.clear();
+  REQUIRE(history.size() == 0);
+  REQUIRE(history.max_size == 3);
+}
+
+template<typename P>
+void test_extrapolate_implicit(int const extrapolate)
+{
+  auto run = [&](int num_extrapolate) -> std::pair<fk::vector<P>, int> {
+    parser parse("diffusion_2", {4, 4});
+    parser_mod::set(parse, parser_mod::degree, 3);
+    parser_mod::set(parse, parser_mod::use_implicit_stepping, true);
+    parser_mod::set(parse, parser_mod::solver_str, "gmres");
+    parser_mod::set(parse, parser_mod::extrapolate, num_extrapolate);
+    parser_mod::set(parse, parser_mod::gmres_tolerance,
+                    std::is_same_v<P, double> ? 1.e-10 : 1.e-5);
+
+    auto pde = make_PDE<P>(parse);
+    options const opts(parse);
+    adapt::distributed_grid adaptive_grid(*pde, opts);
+    basis::wavelet_transform<P, resource::host> const transformer(opts, *pde);
+    generate_dimension_mass_mat(*pde, transformer);
+    generate_all_coefficients(*pde, transformer);
+    fk::vector<P> f_val = adaptive_grid.get_initial_condition(*pde, transformer, opts);
+    generate_dimension_mass_mat(*pde, transformer);
+
+    kron_operators<P> operator_matrices;
+    int iterations = 0;
+    for (int i = 0; i < 10; ++i)
+    {
+      std::cout.setstate(std::ios_base::failbit);
+      f_val = time_advance::adaptive_advance(
+          time_advance::method::imp, *pde, operator_matrices, adaptive_grid,
+          transformer, opts, f_val, i * pde->get_dt(), i == 0);
+      std::cout.clear();
+      iterations += pde->gmres_outputs[0].iterations;
+    }
+    parameter_manager<P>::get_instance().reset();
+    return {std::move(f_val), iterations};
+  };
+
+  auto const [f_plain, iter_plain] = run(0);
+  auto const [f_extra, iter_extra] = run(extrapolate);
+
+  // the solver tolerance is on the preconditioned residual
+  rmse_comparison(f_plain, f_extra, std::is_same_v<P, double> ? P{1e-9} : P{1e-4});
+  REQUIRE(iter_extra < iter_plain);
+}
+
+TEMPLATE_TEST_CASE("extrapolated initial guess", "[extrapolate]", test_precs)
+{
+  if (get_num_ranks() > 1) // implicit stepping is single rank
+    return;
+  SECTION("history") { test_solution_history<TestType>(); }
+  SECTION("implicit, linear") { test_extrapolate_implicit<TestType>(2); }
+  SECTION("implicit, quadratic") { test_extrapolate_implicit<TestType>(3); }
+}